@@ -0,0 +1,677 @@
+/*
+ * Benchmark of the execution engines. Runs every example program with a
+ * fixed synthetic input, under each engine and in each I/O mode that the
+ * program can be used in, and reports steps and bytes per second,
+ * nanoseconds per cycle and peak memory. Results get written as JSON, and
+ * can be compared with a previous run, that was saved as a baseline.
+ *
+ * Usage: comp-bench [--min-time=<seconds>] [--only=<text>]
+ *                   [--output <file>] [--baseline <file>]
+ *                   [--tolerance=<fraction>]
+ *
+ * Must be run from the root of the repository, so it can find examples.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "batch_mode.hpp"
+#include "compile_cache.hpp"
+#include "computer.hpp"
+#include "const.hpp"
+#include "cpu.hpp"
+#include "engine.hpp"
+#include "load.hpp"
+#include "machine_state.hpp"
+#include "parallel_chain.hpp"
+#include "parser.hpp"
+#include "pipe_input.hpp"
+#include "provides_output.hpp"
+#include "ram.hpp"
+#include "standard_output.hpp"
+#include "util.hpp"
+
+using namespace std;
+
+// Size of the text that filters get, and number of keys that cat and
+// mouse gets. Multiply stops after the first pair of numbers.
+const size_t BENCH_TEXT_SIZE = 1 << 18;
+const size_t BENCH_KEYS = 1 << 8;
+const string BENCH_NUMBER_PAIR = "15 17\n";
+// Reference run gives up after this many steps of one computer.
+const unsigned long long BENCH_MAX_STEPS = 1ull << 36;
+
+enum IoMode { WORDS_MODE, CHARS_MODE, FILTER_MODE, BINARY_MODE };
+
+struct BenchCase {
+  string name;
+  vector<string> filenames;
+  IoMode mode;
+  string input;
+};
+
+struct BenchEngine {
+  string name;
+  Engine engine;
+  bool memoize;
+  // Runs the executable that 'compile' command produces, instead.
+  bool compiled;
+};
+
+/*
+ * Timing of one case with one engine. First run also includes loading of
+ * the programs, and everything that engine prepares before the program
+ * runs, like byte filter tables and JIT code, so it is kept apart.
+ */
+struct Measurement {
+  long iterations = 0;
+  double seconds = 0;
+  double firstRunSeconds = 0;
+  bool outputOk = true;
+  // Exit status of the program, if it failed.
+  int status = 0;
+  long peakRssKb = 0;
+};
+
+/*
+ * Runs the program one instruction at a time, without any of the shortcuts
+ * that engines take, and counts the instructions. Number of steps that
+ * programs take for the input is then the same for all engines.
+ */
+class SteppedComputer : public ProvidesOutput {
+  public:
+    SteppedComputer() : ram(Ram()), cpu(Cpu(ram)) { }
+    int getOutput();
+
+    Ram ram;
+    Cpu cpu;
+    unsigned long long steps = 0;
+};
+
+static vector<BenchCase> getCases();
+static vector<BenchEngine> getEngines();
+static string getText(size_t size);
+static string getKeys(size_t count);
+static uint32_t getRandom(uint32_t &state);
+static bool readsChars(IoMode mode);
+static bool printsChars(IoMode mode);
+static string getModeName(IoMode mode);
+static double getTime();
+static int runOnce(const BenchCase &benchCase, ProvidesOutput &last,
+                   PipeInput &input, StandardOutput &output, string &result);
+static unsigned long long getReference(const BenchCase &benchCase,
+                                       string &output);
+static Measurement measureEngine(const BenchCase &benchCase,
+                                 const BenchEngine &engine,
+                                 const string &expected, double minTime);
+static Measurement measureInChild(const BenchCase &benchCase,
+                                  const BenchEngine &engine,
+                                  const string &expected, double minTime);
+static string getExecutable(const BenchCase &benchCase, const string &dir);
+static Measurement measureExecutable(const string &executable,
+                                     const string &inputFilename,
+                                     const string &expected, double minTime);
+static int runExecutable(const string &executable,
+                         const string &inputFilename, string &output,
+                         rusage &usage);
+static string getJson(const BenchCase &benchCase, const BenchEngine &engine,
+                      unsigned long long steps, size_t bytes,
+                      const Measurement &m);
+static map<string, double> readBaseline(const string &filename);
+static string getField(const string &line, const string &name);
+static string getKey(const string &caseName, const string &mode,
+                     const string &engine);
+
+int main(int argc, const char* argv[]) {
+  double minTime = 0.5;
+  double tolerance = 0.1;
+  string only;
+  string outputFilename;
+  string baselineFilename;
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (strncmp(arg, "--min-time=", 11) == 0) {
+      minTime = atof(arg + 11);
+    } else if (strncmp(arg, "--only=", 7) == 0) {
+      only = arg + 7;
+    } else if (strncmp(arg, "--tolerance=", 12) == 0) {
+      tolerance = atof(arg + 12);
+    } else if (Util::contains({ "--output" }, arg) && i+1 < argc) {
+      outputFilename = argv[++i];
+    } else if (Util::contains({ "--baseline" }, arg) && i+1 < argc) {
+      baselineFilename = argv[++i];
+    } else {
+      fprintf(stderr, "Unknown option '%s'. Aborting.\n", arg);
+      return 1;
+    }
+  }
+  if (!Util::isADir("examples/cat-and-mouse")) {
+    fprintf(stderr, "Examples not found, benchmark must be run from the "
+            "root of the repository. Aborting.\n");
+    return 1;
+  }
+  map<string, double> baseline;
+  if (!baselineFilename.empty()) {
+    baseline = readBaseline(baselineFilename);
+  }
+  char dirTemplate[] = "/tmp/comp-bench-XXXXXX";
+  string dir = mkdtemp(dirTemplate);
+  vector<string> results;
+  bool failed = false;
+  fprintf(stderr, "%-14s %-7s %-12s %12s %12s %9s %8s  %s\n", "case", "mode",
+          "engine", "steps/s", "bytes/s", "ns/cycle", "rss kB", "baseline");
+  for (const BenchCase &benchCase : getCases()) {
+    string mode = getModeName(benchCase.mode);
+    vector<BenchEngine> engines;
+    for (const BenchEngine &engine : getEngines()) {
+      string key = getKey(benchCase.name, mode, engine.name);
+      if (key.find(only) != string::npos) {
+        engines.push_back(engine);
+      }
+    }
+    if (engines.empty()) {
+      continue;
+    }
+    string expected;
+    unsigned long long steps = getReference(benchCase, expected);
+    size_t bytes = benchCase.input.size() + expected.size();
+    string inputFilename = dir + "/input";
+    ofstream inputFile(inputFilename, ios::binary);
+    inputFile << benchCase.input;
+    inputFile.close();
+    for (const BenchEngine &engine : engines) {
+      Measurement m;
+      if (engine.compiled) {
+        string executable = getExecutable(benchCase, dir);
+        if (executable.empty()) {
+          m.status = 1;
+        } else {
+          m = measureExecutable(executable, inputFilename, expected, minTime);
+        }
+      } else {
+        m = measureInChild(benchCase, engine, expected, minTime);
+      }
+      results.push_back(getJson(benchCase, engine, steps, bytes, m));
+      string note;
+      if (m.status != 0) {
+        note = "FAILED (" + to_string(m.status) + ")";
+        failed = true;
+      } else if (!m.outputOk) {
+        note = "WRONG OUTPUT";
+        failed = true;
+      } else {
+        auto it = baseline.find(getKey(benchCase.name, mode, engine.name));
+        if (it != baseline.end() && it->second > 0) {
+          double change = steps * m.iterations / m.seconds / it->second - 1;
+          char changeStr[32];
+          snprintf(changeStr, sizeof(changeStr), "%+.1f%%", change * 100);
+          note = changeStr;
+          if (change < -tolerance) {
+            note += " REGRESSION";
+            failed = true;
+          }
+        }
+      }
+      double perRun = m.iterations > 0 ? m.seconds / m.iterations : 0;
+      fprintf(stderr, "%-14s %-7s %-12s %12.4g %12.4g %9.3f %8ld  %s\n",
+              benchCase.name.c_str(), mode.c_str(), engine.name.c_str(),
+              perRun > 0 ? steps / perRun : 0, perRun > 0 ? bytes / perRun : 0,
+              steps > 0 ? perRun * 1e9 / steps : 0, m.peakRssKb,
+              note.c_str());
+    }
+  }
+  system(("rm -rf " + dir).c_str());
+  string json = "{\n  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    json += "    " + results[i] + (i+1 < results.size() ? ",\n" : "\n");
+  }
+  json += "  ]\n}\n";
+  if (outputFilename.empty()) {
+    fputs(json.c_str(), stdout);
+  } else {
+    ofstream out(outputFilename);
+    out << json;
+  }
+  return failed ? 1 : 0;
+}
+
+int SteppedComputer::getOutput() {
+  while (true) {
+    if (++steps > BENCH_MAX_STEPS) {
+      BatchMode::failJob(7);
+    }
+    if (!cpu.step()) {
+      steps--;
+      ParallelChain::stop(NO_OUTPUT);
+    }
+    if (ram.outputPending) {
+      ram.outputPending = false;
+      return ram.output;
+    }
+  }
+}
+
+///////////////
+/// PRIVATE ///
+///////////////
+
+/*
+ * Programs of the cat and mouse chain get the keys as a filter, since game
+ * mode reads directly from the keyboard. Print without read is a chain
+ * whose last program never reads, so its predecessor never runs.
+ */
+static vector<BenchCase> getCases() {
+  vector<string> fibonacci = { "examples/fibonacci.cm2" };
+  vector<string> helloWorld = { "examples/hello-world.cm2" };
+  vector<string> multiply = { "examples/multiply.cm2" };
+  vector<string> toUpperCase = { "examples/to-upper-case.cm2" };
+  vector<string> printWithoutRead = { "examples/to-upper-case.cm2",
+                                      "bench/print-without-read.cm2" };
+  vector<string> catAndMouse =
+      Util::getFilesInDirectory("examples/cat-and-mouse");
+  string text = getText(BENCH_TEXT_SIZE);
+  return {
+    { "fibonacci", fibonacci, WORDS_MODE, "" },
+    { "fibonacci", fibonacci, CHARS_MODE, "" },
+    { "hello-world", helloWorld, CHARS_MODE, "" },
+    { "multiply", multiply, WORDS_MODE, BENCH_NUMBER_PAIR },
+    { "to-upper-case", toUpperCase, FILTER_MODE, text },
+    { "to-upper-case", toUpperCase, BINARY_MODE, text },
+    { "cat-and-mouse", catAndMouse, FILTER_MODE, getKeys(BENCH_KEYS) },
+    { "print-no-read", printWithoutRead, FILTER_MODE, "" }
+  };
+}
+
+static vector<BenchEngine> getEngines() {
+  return {
+    { "interpreter", INTERPRETER_ENGINE, false, false },
+    { "threaded", THREADED_ENGINE, false, false },
+    { "jit", JIT_ENGINE, false, false },
+    { "tiered", TIERED_ENGINE, false, false },
+    { "memoize", TIERED_ENGINE, true, false },
+    { "compiled", TIERED_ENGINE, false, true }
+  };
+}
+
+/*
+ * Lines of up to 80 printable characters.
+ */
+static string getText(size_t size) {
+  uint32_t state = 1;
+  string out;
+  while (out.size() < size) {
+    size_t lineLength = getRandom(state) % 80;
+    for (size_t i = 0; i < lineLength && out.size() < size - 1; i++) {
+      out += (char) (' ' + getRandom(state) % 95);
+    }
+    out += '\n';
+  }
+  return out;
+}
+
+/*
+ * Letters that move the mouse and escape sequences of arrows, that move
+ * the cat.
+ */
+static string getKeys(size_t count) {
+  const vector<string> keys = { "w", "a", "s", "d", "\x1b[A", "\x1b[B",
+                                "\x1b[C", "\x1b[D" };
+  uint32_t state = 3;
+  string out;
+  for (size_t i = 0; i < count; i++) {
+    out += keys[getRandom(state) % keys.size()];
+  }
+  return out;
+}
+
+/*
+ * Same sequence on every platform, unlike 'rand()'.
+ */
+static uint32_t getRandom(uint32_t &state) {
+  state = state * 1103515245u + 12345u;
+  return state >> 16;
+}
+
+static bool readsChars(IoMode mode) {
+  return mode == FILTER_MODE || mode == BINARY_MODE;
+}
+
+static bool printsChars(IoMode mode) {
+  return mode != WORDS_MODE;
+}
+
+static string getModeName(IoMode mode) {
+  switch (mode) {
+    case WORDS_MODE: return "words";
+    case CHARS_MODE: return "chars";
+    case FILTER_MODE: return "filter";
+    case BINARY_MODE: return "binary";
+  }
+  return "";
+}
+
+static double getTime() {
+  return chrono::duration<double>(
+      chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * Runs the chain over the whole input, as if it was piped into 'comp'.
+ * Returns the status that the program failed with, or zero.
+ */
+static int runOnce(const BenchCase &benchCase, ProvidesOutput &last,
+                   PipeInput &input, StandardOutput &output, string &result) {
+  input.setRecord(benchCase.input.data(), benchCase.input.size());
+  result.clear();
+  output.capture = &result;
+  int status = BatchMode::runJob([&]() {
+    while (true) {
+      int word = last.getOutput();
+      if (word == NO_OUTPUT) {
+        return;
+      }
+      output.print(word);
+    }
+  }, true);
+  output.finish();
+  return status;
+}
+
+/*
+ * Returns the number of steps that all computers of the chain take, and
+ * sets the output that results of engines get compared with.
+ */
+static unsigned long long getReference(const BenchCase &benchCase,
+                                       string &output) {
+  vector<SteppedComputer> chain(benchCase.filenames.size());
+  for (size_t i = 0; i < chain.size(); i++) {
+    Load::fillRamWithFile(benchCase.filenames[i].c_str(), chain[i].ram);
+  }
+  PipeInput input(readsChars(benchCase.mode), false,
+                  benchCase.mode == BINARY_MODE);
+  StandardOutput out(false, printsChars(benchCase.mode), false);
+  input.output = &out;
+  chain[0].ram.input = &input;
+  for (size_t i = 1; i < chain.size(); i++) {
+    chain[i].ram.input = &chain[i-1];
+  }
+  runOnce(benchCase, chain.back(), input, out, output);
+  unsigned long long steps = 0;
+  for (SteppedComputer &computer : chain) {
+    steps += computer.steps;
+  }
+  return steps;
+}
+
+/*
+ * Loads the chain and runs it until 'minTime' seconds of runs after the
+ * first one add up.
+ */
+static Measurement measureEngine(const BenchCase &benchCase,
+                                 const BenchEngine &engine,
+                                 const string &expected, double minTime) {
+  Measurement m;
+  double start = getTime();
+  vector<Computer> chain(benchCase.filenames.size());
+  vector<MachineState> initialStates;
+  for (size_t i = 0; i < chain.size(); i++) {
+    Load::fillRamWithFile(benchCase.filenames[i].c_str(), chain[i].ram);
+    chain[i].setEngine(engine.engine);
+    chain[i].name = benchCase.filenames[i];
+    chain[i].memoize = engine.memoize;
+    initialStates.push_back(chain[i].cpu.getState());
+  }
+  PipeInput input(readsChars(benchCase.mode), false,
+                  benchCase.mode == BINARY_MODE);
+  StandardOutput output(false, printsChars(benchCase.mode), false);
+  input.output = &output;
+  chain[0].ram.input = &input;
+  for (size_t i = 1; i < chain.size(); i++) {
+    chain[i].ram.input = &chain[i-1];
+  }
+  string result;
+  bool first = true;
+  while (m.iterations == 0 || m.seconds < minTime) {
+    double runStart = getTime();
+    for (size_t i = 0; i < chain.size(); i++) {
+      chain[i].restart(initialStates[i]);
+    }
+    m.status = runOnce(benchCase, chain.back(), input, output, result);
+    double end = getTime();
+    if (m.status != 0) {
+      return m;
+    }
+    m.outputOk = m.outputOk && result == expected;
+    if (first) {
+      m.firstRunSeconds = end - start;
+      first = false;
+    } else {
+      m.iterations++;
+      m.seconds += end - runStart;
+    }
+  }
+  return m;
+}
+
+/*
+ * Measures the engine in a new process, so that its peak memory doesn't
+ * include memory of other runs, and a program that exits doesn't end the
+ * benchmark.
+ */
+static Measurement measureInChild(const BenchCase &benchCase,
+                                  const BenchEngine &engine,
+                                  const string &expected, double minTime) {
+  int fds[2];
+  if (pipe(fds) == -1) {
+    fprintf(stderr, "Could not create a pipe. Aborting.\n");
+    exit(1);
+  }
+  fflush(stdout);
+  fflush(stderr);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    Measurement m = measureEngine(benchCase, engine, expected, minTime);
+    ssize_t num = write(fds[1], &m, sizeof(m));
+    _exit(num == sizeof(m) ? 0 : 1);
+  }
+  close(fds[1]);
+  Measurement m;
+  ssize_t num;
+  do {
+    num = read(fds[0], &m, sizeof(m));
+  } while (num == -1 && errno == EINTR);
+  close(fds[0]);
+  int status;
+  rusage usage;
+  wait4(pid, &status, 0, &usage);
+  if (num != sizeof(m)) {
+    m = Measurement();
+    m.status = WIFEXITED(status) ? WEXITSTATUS(status)
+                                 : 128 + WTERMSIG(status);
+    m.status = max(m.status, 1);
+  }
+  m.peakRssKb = usage.ru_maxrss;
+  return m;
+}
+
+/*
+ * Builds the executable like 'compile' command does, and keeps it in the
+ * same cache. Returns empty string if it couldn't be built.
+ */
+static string getExecutable(const BenchCase &benchCase, const string &dir) {
+  string source = Parser::parse(benchCase.filenames,
+                                printsChars(benchCase.mode),
+                                readsChars(benchCase.mode), false,
+                                benchCase.mode == BINARY_MODE);
+  string key = CompileCache::getKey(source, GCC_COMMAND);
+  string executable = dir + "/" + key;
+  if (CompileCache::fetch(source, GCC_COMMAND, executable)) {
+    return executable;
+  }
+  string sourceName = executable + ".cpp";
+  ofstream sourceFile(sourceName);
+  sourceFile << source;
+  sourceFile.close();
+  string command = GCC_COMMAND + " " + executable + " " + sourceName;
+  if (system(command.c_str()) != 0) {
+    return "";
+  }
+  CompileCache::store(source, GCC_COMMAND, executable);
+  return executable;
+}
+
+/*
+ * Every run is a new process, like when the executable gets used in a
+ * pipeline, so its startup is part of the measurement.
+ */
+static Measurement measureExecutable(const string &executable,
+                                     const string &inputFilename,
+                                     const string &expected, double minTime) {
+  Measurement m;
+  string result;
+  bool first = true;
+  while (m.iterations == 0 || m.seconds < minTime) {
+    rusage usage;
+    double start = getTime();
+    m.status = runExecutable(executable, inputFilename, result, usage);
+    double seconds = getTime() - start;
+    if (m.status != 0) {
+      return m;
+    }
+    m.outputOk = m.outputOk && result == expected;
+    m.peakRssKb = max(m.peakRssKb, (long) usage.ru_maxrss);
+    if (first) {
+      m.firstRunSeconds = seconds;
+      first = false;
+    } else {
+      m.iterations++;
+      m.seconds += seconds;
+    }
+  }
+  return m;
+}
+
+/*
+ * Returns exit status of the executable, or 128 plus the signal that
+ * killed it.
+ */
+static int runExecutable(const string &executable,
+                         const string &inputFilename, string &output,
+                         rusage &usage) {
+  int fds[2];
+  if (pipe(fds) == -1) {
+    fprintf(stderr, "Could not create a pipe. Aborting.\n");
+    exit(1);
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    int in = open(inputFilename.c_str(), O_RDONLY);
+    dup2(in, 0);
+    dup2(fds[1], 1);
+    close(in);
+    close(fds[0]);
+    close(fds[1]);
+    execl(executable.c_str(), executable.c_str(), (char*) NULL);
+    _exit(127);
+  }
+  close(fds[1]);
+  output.clear();
+  vector<char> buffer(OUTPUT_BUFFER_SIZE);
+  while (true) {
+    ssize_t num = read(fds[0], buffer.data(), buffer.size());
+    if (num == -1 && errno == EINTR) {
+      continue;
+    }
+    if (num <= 0) {
+      break;
+    }
+    output.append(buffer.data(), num);
+  }
+  close(fds[0]);
+  int status;
+  wait4(pid, &status, 0, &usage);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+/*
+ * One result per line, so that 'readBaseline()' doesn't need a JSON
+ * parser. Seconds are per run, not counting the first one.
+ */
+static string getJson(const BenchCase &benchCase, const BenchEngine &engine,
+                      unsigned long long steps, size_t bytes,
+                      const Measurement &m) {
+  double perRun = m.iterations > 0 ? m.seconds / m.iterations : 0;
+  bool valid = m.status == 0 && perRun > 0;
+  char numbers[512];
+  snprintf(numbers, sizeof(numbers),
+           "\"runs\": %ld, \"steps\": %llu, \"bytes\": %zu, "
+           "\"seconds\": %.9f, \"first_run_seconds\": %.9f, "
+           "\"steps_per_sec\": %.0f, \"bytes_per_sec\": %.0f, "
+           "\"ns_per_cycle\": %.4f, \"peak_rss_kb\": %ld, "
+           "\"output_ok\": %s, \"status\": %d",
+           m.iterations, steps, bytes, perRun, m.firstRunSeconds,
+           valid ? steps / perRun : 0, valid ? bytes / perRun : 0,
+           valid && steps > 0 ? perRun * 1e9 / steps : 0, m.peakRssKb,
+           m.outputOk ? "true" : "false", m.status);
+  return "{\"case\": \"" + benchCase.name + "\", \"mode\": \"" +
+         getModeName(benchCase.mode) + "\", \"engine\": \"" + engine.name +
+         "\", " + numbers + "}";
+}
+
+/*
+ * Returns steps per second of every result in the file, that has to be
+ * written by this program.
+ */
+static map<string, double> readBaseline(const string &filename) {
+  ifstream file(filename);
+  if (file.fail()) {
+    fprintf(stderr, "Could not open baseline '%s'. Aborting.\n",
+            filename.c_str());
+    exit(1);
+  }
+  map<string, double> out;
+  string line;
+  while (getline(file, line)) {
+    string caseName = getField(line, "case");
+    if (caseName.empty()) {
+      continue;
+    }
+    string key = getKey(caseName, getField(line, "mode"),
+                        getField(line, "engine"));
+    out[key] = atof(getField(line, "steps_per_sec").c_str());
+  }
+  return out;
+}
+
+static string getField(const string &line, const string &name) {
+  string pattern = "\"" + name + "\": ";
+  size_t start = line.find(pattern);
+  if (start == string::npos) {
+    return "";
+  }
+  start += pattern.size();
+  if (line[start] == '"') {
+    start++;
+    return line.substr(start, line.find('"', start) - start);
+  }
+  return line.substr(start, line.find_first_of(",}", start) - start);
+}
+
+static string getKey(const string &caseName, const string &mode,
+                     const string &engine) {
+  return caseName + "/" + mode + "/" + engine;
+}
\ No newline at end of file
@@ -2,10 +2,8 @@
 
 #include <string>
 
-#include "util.hpp"
-
 string Address::getIntStr() const {
-  return to_string(Util::getInt(val));
+  return to_string(val);
 }
 
 string Address::toString(AddrSpace space) {
@@ -1,26 +1,36 @@
-
 #ifndef ADDRESS_H
 #define ADDRESS_H
 
+#include <stdint.h>
 #include <string>
-#include <vector>
+#include <type_traits>
 
 #include "addr_space.hpp"
 
 using namespace std;
 
+/*
+ * Address space together with 4 bit value of the address. It is trivially
+ * copyable, so it can be passed around by value.
+ */
 class Address {
   public:
-    Address(const AddrSpace spaceIn, vector<bool> valIn)
+    Address()
+        : space(NONE),
+          val(0) { }
+    Address(const AddrSpace spaceIn, uint8_t valIn)
         : space(spaceIn), 
           val(valIn) { }
     bool operator == (const Address& other) const {
       return space == other.space && val == other.val;
     }
     string getIntStr() const;
-    AddrSpace const space;
-    vector<bool> const val;
+    AddrSpace space;
+    uint8_t val;
     static string toString(AddrSpace space);
 };
 
+static_assert(is_trivially_copyable<Address>::value,
+              "Address should be trivially copyable.");
+
 #endif
\ No newline at end of file
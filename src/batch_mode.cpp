@@ -0,0 +1,204 @@
+#include "batch_mode.hpp"
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "const.hpp"
+#include "load.hpp"
+
+using namespace std;
+
+// Where the job that runs on this thread continues after it ends. Frames
+// that 'longjmp()' skips, from the chain down to its input, hold no objects
+// with destructors.
+static thread_local jmp_buf *jobEnd = NULL;
+// Set if the job can end with an error, without ending the program. Used
+// by server, so that one bad request doesn't stop it.
+static thread_local bool jobCanFail = false;
+static thread_local int jobStatus = 0;
+
+static void work(vector<unique_ptr<BatchWorker>> &workers, size_t index,
+                 const vector<string> &records, vector<string> &results);
+static bool takeJob(BatchWorker &worker, size_t &job, bool fromBack);
+
+BatchWorker::BatchWorker(vector<string> filenames, bool outputNumbers,
+                         bool outputChars, bool inputChars, Engine engine,
+                         bool memoize)
+    : computerChain(vector<Computer>(filenames.size())),
+      input(PipeInput(inputChars, false, false)),
+      output(StandardOutput(outputNumbers, outputChars, false)) {
+  for (size_t i = 0; i < filenames.size(); i++) {
+    Load::fillRamWithFile(filenames[i].c_str(), computerChain[i].ram);
+    computerChain[i].setEngine(engine);
+    computerChain[i].name = filenames[i];
+    computerChain[i].memoize = memoize;
+    initialStates.push_back(computerChain[i].cpu.getState());
+  }
+  computerChain[0].ram.input = &input;
+  for (size_t i = 1; i < computerChain.size(); i++) {
+    computerChain[i].ram.input = &computerChain[i-1];
+  }
+}
+
+void BatchWorker::runJob(const string &record, string &result) {
+  for (size_t i = 0; i < computerChain.size(); i++) {
+    computerChain[i].restart(initialStates[i]);
+  }
+  input.setRecord(record.data(), record.size());
+  result.clear();
+  output.capture = &result;
+  BatchMode::runJob([&]() {
+    while (true) {
+      int word = computerChain.back().getOutput();
+      if (word == NO_OUTPUT) {
+        return;
+      }
+      output.print(word);
+      if (result.size() > MAX_BATCH_OUTPUT) {
+        fprintf(stderr, "Output of record '%s' is too long. Aborting.\n",
+                record.c_str());
+        exit(8);
+      }
+    }
+  }, false);
+  output.flush();
+}
+
+BatchMode::BatchMode(vector<string> filenames, bool outputNumbers,
+                     bool outputChars, bool inputChars, Engine engine,
+                     bool memoize, char delimiterIn)
+    : delimiter(delimiterIn) {
+  size_t numOfWorkers = max(thread::hardware_concurrency(), 1u);
+  for (size_t i = 0; i < numOfWorkers; i++) {
+    workers.push_back(unique_ptr<BatchWorker>(
+        new BatchWorker(filenames, outputNumbers, outputChars, inputChars,
+                        engine, memoize)));
+  }
+}
+
+BatchMode::~BatchMode() {
+  free(line);
+}
+
+void BatchMode::run() {
+  while (readRecords()) {
+    processRecords();
+    printResults();
+  }
+}
+
+int BatchMode::runJob(const function<void()> &job, bool canFail) {
+  jmp_buf end;
+  jobEnd = &end;
+  jobCanFail = canFail;
+  jobStatus = 0;
+  if (setjmp(end) == 0) {
+    job();
+  }
+  jobEnd = NULL;
+  jobCanFail = false;
+  return jobStatus;
+}
+
+void BatchMode::endJob() {
+  if (jobEnd != NULL) {
+    longjmp(*jobEnd, 1);
+  }
+}
+
+void BatchMode::failJob(int status) {
+  if (jobEnd != NULL && jobCanFail) {
+    jobStatus = status;
+    longjmp(*jobEnd, 1);
+  }
+}
+
+///////////////
+/// PRIVATE ///
+///////////////
+
+/*
+ * Reads up to BATCH_RECORDS records from stdin. Returns false if there
+ * were none left.
+ */
+bool BatchMode::readRecords() {
+  records.clear();
+  while (records.size() < BATCH_RECORDS) {
+    ssize_t size = getdelim(&line, &lineCapacity, delimiter, stdin);
+    if (size == -1) {
+      break;
+    }
+    if (size > 0 && line[size-1] == delimiter) {
+      size--;
+    }
+    records.push_back(string(line, size));
+  }
+  return !records.empty();
+}
+
+/*
+ * Each worker gets an equal share of consecutive records, and then
+ * helps others when it finishes its own.
+ */
+void BatchMode::processRecords() {
+  results.resize(records.size());
+  size_t numOfWorkers = workers.size();
+  for (size_t i = 0; i < numOfWorkers; i++) {
+    size_t first = i * records.size() / numOfWorkers;
+    size_t last = (i+1) * records.size() / numOfWorkers;
+    for (size_t job = first; job < last; job++) {
+      workers[i]->jobs.push_back(job);
+    }
+  }
+  vector<thread> threads;
+  for (size_t i = 0; i < numOfWorkers; i++) {
+    threads.push_back(thread(work, ref(workers), i, cref(records),
+                             ref(results)));
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+}
+
+void BatchMode::printResults() {
+  for (size_t i = 0; i < records.size(); i++) {
+    fwrite(results[i].data(), 1, results[i].size(), stdout);
+    putchar(delimiter);
+  }
+  fflush(stdout);
+}
+
+static void work(vector<unique_ptr<BatchWorker>> &workers, size_t index,
+                 const vector<string> &records, vector<string> &results) {
+  BatchWorker &worker = *workers[index];
+  size_t job;
+  while (true) {
+    bool found = takeJob(worker, job, false);
+    for (size_t i = 1; !found && i < workers.size(); i++) {
+      found = takeJob(*workers[(index + i) % workers.size()], job, true);
+    }
+    if (!found) {
+      return;
+    }
+    worker.runJob(records[job], results[job]);
+  }
+}
+
+static bool takeJob(BatchWorker &worker, size_t &job, bool fromBack) {
+  lock_guard<mutex> lock(worker.jobsMutex);
+  if (worker.jobs.empty()) {
+    return false;
+  }
+  if (fromBack) {
+    job = worker.jobs.back();
+    worker.jobs.pop_back();
+  } else {
+    job = worker.jobs.front();
+    worker.jobs.pop_front();
+  }
+  return true;
+}
\ No newline at end of file
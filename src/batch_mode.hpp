@@ -0,0 +1,78 @@
+#ifndef BATCH_MODE_H
+#define BATCH_MODE_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "computer.hpp"
+#include "engine.hpp"
+#include "machine_state.hpp"
+#include "pipe_input.hpp"
+#include "standard_output.hpp"
+
+using namespace std;
+
+/*
+ * Chain of computers that processes batch jobs on one thread. Programs get
+ * loaded only once, and are restarted before each job.
+ */
+class BatchWorker {
+  public:
+    BatchWorker(vector<string> filenames, bool outputNumbers,
+                bool outputChars, bool inputChars, Engine engine,
+                bool memoize);
+    void runJob(const string &record, string &result);
+
+    // Indices of records that are waiting to be processed by this worker.
+    // Other workers take them from the back when they run out of their own.
+    deque<size_t> jobs;
+    mutex jobsMutex;
+
+  private:
+    vector<Computer> computerChain;
+    vector<MachineState> initialStates;
+    PipeInput input;
+    StandardOutput output;
+};
+
+/*
+ * Runs the chain once for every record (line or NUL terminated string) of
+ * the input, as if each record was piped into a separate process. Records
+ * get processed in parallel, one worker per core, while output is printed
+ * in the order of the records, each followed by the delimiter.
+ */
+class BatchMode {
+  public:
+    BatchMode(vector<string> filenames, bool outputNumbers, bool outputChars,
+              bool inputChars, Engine engine, bool memoize, char delimiter);
+    ~BatchMode();
+    void run();
+    // Runs the job on the calling thread until it returns, or until it
+    // calls 'endJob()' or 'failJob()'. Returns the status that the job
+    // failed with, or zero.
+    static int runJob(const function<void()> &job, bool canFail);
+    // Ends the job that is running on the calling thread, if there is one.
+    static void endJob();
+    // Ends the job with the status, if it is allowed to fail. Otherwise
+    // returns and the caller should exit the program.
+    static void failJob(int status);
+
+  private:
+    vector<unique_ptr<BatchWorker>> workers;
+    char delimiter;
+    vector<string> records;
+    vector<string> results;
+    char *line = NULL;
+    size_t lineCapacity = 0;
+
+    bool readRecords();
+    void processRecords();
+    void printResults();
+};
+
+#endif
\ No newline at end of file
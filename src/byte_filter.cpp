@@ -0,0 +1,105 @@
+#include "byte_filter.hpp"
+
+#include <unordered_set>
+#include <vector>
+
+#include "const.hpp"
+#include "cpu.hpp"
+#include "engine.hpp"
+#include "input_probe.hpp"
+#include "machine_state.hpp"
+#include "provides_output.hpp"
+#include "ram.hpp"
+
+using namespace std;
+
+/*
+ * Runs the program up to its first input read, and then from there once
+ * for every possible input word. The same gets repeated for all the states
+ * that program gets into before its next read. Returns 'true' if program
+ * sent the same word to output for the same input from all of them, in
+ * which case the cpu is left in the state before the first read. Otherwise
+ * cpu gets restored to the state it was in.
+ */
+bool ByteFilter::compile(Cpu &cpu, Ram &ram) {
+  MachineState initialState = cpu.getState();
+  prologueOutput.clear();
+  RunResult result = cpu.runUntilInput(MEMO_STEPS, prologueOutput);
+  MachineState readState = cpu.getState();
+  if (result != RUN_INPUT || !checkReadStates(cpu, ram, readState)) {
+    cpu.setState(initialState);
+    prologueOutput.clear();
+    return false;
+  }
+  cpu.setState(readState);
+  return true;
+}
+
+uint8_t ByteFilter::apply(uint8_t word) const {
+  return table[word];
+}
+
+/*
+ * Fills the table with outputs from the first read state, and checks
+ * that all other reachable read states produce the same ones.
+ */
+bool ByteFilter::checkReadStates(Cpu &cpu, Ram &ram,
+                                 const MachineState &readState) {
+  unordered_set<MachineState, MachineStateHash> reached = { readState };
+  vector<MachineState> unchecked = { readState };
+  bool tableFilled = false;
+  int startCycle = cpu.getCycle();
+  while (!unchecked.empty()) {
+    MachineState state = unchecked.back();
+    unchecked.pop_back();
+    for (int word = 0; word < 256; word++) {
+      uint8_t outputWord;
+      if (!runPass(cpu, ram, state, word, outputWord)) {
+        return false;
+      }
+      if (!tableFilled) {
+        table[word] = outputWord;
+      } else if (table[word] != outputWord) {
+        return false;
+      }
+      if (reached.insert(cpu.getState()).second) {
+        unchecked.push_back(cpu.getState());
+      }
+    }
+    tableFilled = true;
+    if (reached.size() > MAX_FILTER_STATES ||
+        cpu.getCycle() - startCycle > MAX_FILTER_CHECK_STEPS) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Executes the program from the passed read state with the passed input
+ * word, until the next read. Returns 'false' if it didn't get to the next
+ * read, or if it didn't send exactly one word to output on the way.
+ */
+bool ByteFilter::runPass(Cpu &cpu, Ram &ram, const MachineState &state,
+                         uint8_t word, uint8_t &outputWord) {
+  cpu.setState(state);
+  InputProbe probe;
+  probe.value = word;
+  ProvidesOutput *input = ram.input;
+  unsigned long inputCount = ram.inputCount;
+  ram.input = &probe;
+  cpu.step();
+  ram.input = input;
+  ram.inputCount = inputCount;
+  vector<uint8_t> output;
+  if (ram.outputPending) {
+    ram.outputPending = false;
+    output.push_back(ram.output);
+  }
+  RunResult result = cpu.runUntilInput(MEMO_STEPS, output);
+  if (result != RUN_INPUT || output.size() != 1) {
+    return false;
+  }
+  outputWord = output[0];
+  return true;
+}
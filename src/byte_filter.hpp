@@ -0,0 +1,35 @@
+#ifndef BYTE_FILTER_H
+#define BYTE_FILTER_H
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+
+#include "cpu.hpp"
+#include "machine_state.hpp"
+#include "ram.hpp"
+
+using namespace std;
+
+/*
+ * Program that sends exactly one word to output after each input word,
+ * and the word depends only on the input word, can be replaced by a table
+ * with an entry for each of the 256 possible words.
+ */
+class ByteFilter {
+  public:
+    bool compile(Cpu &cpu, Ram &ram);
+    uint8_t apply(uint8_t word) const;
+
+    // Words that program sends to output before its first input read.
+    vector<uint8_t> prologueOutput;
+
+  private:
+    array<uint8_t, 256> table;
+
+    bool checkReadStates(Cpu &cpu, Ram &ram, const MachineState &readState);
+    bool runPass(Cpu &cpu, Ram &ram, const MachineState &state,
+                 uint8_t word, uint8_t &outputWord);
+};
+
+#endif
\ No newline at end of file
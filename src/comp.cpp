@@ -1,15 +1,23 @@
 #include "comp.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "batch_mode.hpp"
+#include "compile_cache.hpp"
+#include "engine.hpp"
 #include "parser.hpp"
 #include "interactive_mode.hpp"
 #include "noninteractive_mode.hpp"
+#include "server_mode.hpp"
+#include "topology.hpp"
+#include "trace.hpp"
 #include "util.hpp"
 
 using namespace std;
@@ -18,8 +26,11 @@ void assertFilenames();
 bool inputIsNotPiped();
 void processArguments(int argc, const char* argv[]);
 void processFilename(string filename);
+Engine getEngine(string name);
+size_t getWorkerCount(const char *count);
 string getFilenameOut();
-void saveSourceToFile(string filenameOut);
+string getSource();
+void saveSourceToFile(string source, string filenameOut);
 void loadAllFilesFromDir(string dirname);
 string getFirstFilename();
 
@@ -30,8 +41,23 @@ bool outputChars = false;
 bool outputNumbers = false;
 bool inputChars = false;
 bool rawInput = false;
+bool binary = false;
 bool compile = false;
 bool parse = false;
+bool serve = false;
+Engine engine = TIERED_ENGINE;
+bool memoize = false;
+bool profile = false;
+string traceFilename;
+bool decodeTrace = false;
+bool parallelChain = false;
+size_t fiberWorkers = 0;
+bool batch = false;
+char batchDelimiter = '\n';
+string inputFilename;
+string outputFilename;
+string topologyFilename;
+string socketPath;
 
 int main(int argc, const char* argv[]) {
   srand(time(NULL));
@@ -40,30 +66,72 @@ int main(int argc, const char* argv[]) {
     interactivieMode = inputIsNotPiped();
   }
   if (outputChars == false) {
-    outputNumbers = !Util::outputIsPiped();
+    outputNumbers = outputFilename.empty() && !Util::outputIsPiped();
+  }
+  bool instrumented = profile || (!traceFilename.empty() && !decodeTrace);
+  if (instrumented && (serve || batch || !socketPath.empty() ||
+                       !topologyFilename.empty())) {
+    cout << "Options --profile and --trace can't be used with a topology, "
+            "batch or server mode. Aborting.";
+    exit(1);
+  }
+  // Stages of a parallel chain keep running while the profiles get
+  // printed at exit.
+  if (profile && parallelChain) {
+    cout << "Option --profile can't be used with --parallel-chain or "
+            "--fibers. Aborting.";
+    exit(1);
   }
   if (compile) {
     assertFilenames();
     string filenameOut = getFilenameOut();
+    string source = getSource();
+    if (CompileCache::fetch(source, GCC_COMMAND, filenameOut)) {
+      cout << "Compiled as " + filenameOut + " (cached)" << endl;
+      return 0;
+    }
     string sourceNameOut = "/tmp/"+filenameOut+".cpp";
-    saveSourceToFile(sourceNameOut);
+    saveSourceToFile(source, sourceNameOut);
     string command = GCC_COMMAND+" "+filenameOut+" "+sourceNameOut;
     int statusCode = system(command.c_str());
     if (statusCode == 0) {
+      CompileCache::store(source, GCC_COMMAND, filenameOut);
       cout << "Compiled as " + filenameOut << endl;
     }  
   } else if (parse) {
     assertFilenames();
     string filenameOut = getFilenameOut();
-    saveSourceToFile(filenameOut+".cpp");
+    saveSourceToFile(getSource(), filenameOut+".cpp");
     cout << "Source saved to " + filenameOut + ".cpp" << endl;
+  } else if (serve) {
+    ServerMode::serve(socketPath);
+  } else if (decodeTrace) {
+    Trace::print(traceFilename);
   } else if (interactivieMode) {
     InteractiveMode::startInteractiveMode(getFirstFilename());
+  } else if (!topologyFilename.empty()) {
+    Topology topology(topologyFilename, outputNumbers, outputChars,
+                      inputChars, rawInput, binary, engine, memoize,
+                      fiberWorkers);
+    topology.run();
+  } else if (!socketPath.empty()) {
+    assertFilenames();
+    ServerMode::sendRequest(socketPath, filenames, outputNumbers, outputChars,
+                            inputChars, binary, engine, memoize);
+  } else if (batch) {
+    assertFilenames();
+    BatchMode mode(filenames, outputNumbers, outputChars, inputChars, engine,
+                   memoize, batchDelimiter);
+    mode.run();
   } else {
     assertFilenames();
     NoninteractiveMode mode = NoninteractiveMode(filenames, outputNumbers,
                                                  outputChars, inputChars, 
-                                                 rawInput);
+                                                 rawInput, binary, engine,
+                                                 memoize, parallelChain,
+                                                 fiberWorkers, inputFilename,
+                                                 outputFilename, profile,
+                                                 traceFilename);
     mode.run();
   }
 }
@@ -99,10 +167,63 @@ void processArguments(int argc, const char* argv[]) {
       outputChars = true;
       inputChars = true;
       rawInput = true;
+    } else if (Util::contains({ "-b", "--binary"}, arg)) {
+      interactivieMode = false;
+      outputChars = true;
+      inputChars = true;
+      binary = true;
+    } else if (strncmp(arg, "--engine=", 9) == 0) {
+      interactivieMode = false;
+      engine = getEngine(arg + 9);
+    } else if (Util::contains({ "--memoize" }, arg)) {
+      interactivieMode = false;
+      memoize = true;
+    } else if (Util::contains({ "--profile" }, arg)) {
+      interactivieMode = false;
+      profile = true;
+    } else if (strncmp(arg, "--trace=", 8) == 0) {
+      interactivieMode = false;
+      traceFilename = arg + 8;
+    } else if (Util::contains({ "--parallel-chain" }, arg)) {
+      interactivieMode = false;
+      parallelChain = true;
+    } else if (Util::contains({ "--fibers" }, arg)) {
+      interactivieMode = false;
+      parallelChain = true;
+      fiberWorkers = getWorkerCount("");
+    } else if (strncmp(arg, "--fibers=", 9) == 0) {
+      interactivieMode = false;
+      parallelChain = true;
+      fiberWorkers = getWorkerCount(arg + 9);
+    } else if (Util::contains({ "--input" }, arg) && i+1 < argc) {
+      interactivieMode = false;
+      inputFilename = argv[++i];
+    } else if (Util::contains({ "--output" }, arg) && i+1 < argc) {
+      interactivieMode = false;
+      outputFilename = argv[++i];
+    } else if (Util::contains({ "--topology" }, arg) && i+1 < argc) {
+      interactivieMode = false;
+      topologyFilename = argv[++i];
+    } else if (Util::contains({ "--server" }, arg) && i+1 < argc) {
+      interactivieMode = false;
+      socketPath = argv[++i];
+    } else if (Util::contains({ "--batch" }, arg)) {
+      interactivieMode = false;
+      batch = true;
+    } else if (Util::contains({ "--batch-null" }, arg)) {
+      interactivieMode = false;
+      batch = true;
+      batchDelimiter = '\0';
     } else if (Util::contains({ "compile" }, arg)) {
       compile = true;
     } else if (Util::contains({ "parse" }, arg)) {
       parse = true;
+    } else if (Util::contains({ "serve" }, arg) && i+1 < argc) {
+      serve = true;
+      socketPath = argv[++i];
+    } else if (Util::contains({ "decode-trace" }, arg) && i+1 < argc) {
+      decodeTrace = true;
+      traceFilename = argv[++i];
     } else {
       processFilename(argv[i]);
     }
@@ -118,6 +239,35 @@ void processFilename(string filename) {
   }
 }
 
+Engine getEngine(string name) {
+  if (name == "interpreter") {
+    return INTERPRETER_ENGINE;
+  } else if (name == "threaded") {
+    return THREADED_ENGINE;
+  } else if (name == "jit") {
+    return JIT_ENGINE;
+  } else if (name == "tiered") {
+    return TIERED_ENGINE;
+  }
+  cout << "Unknown engine '" << name << "'. Aborting.";
+  exit(1);
+}
+
+/*
+ * Returns one worker per core if count is empty.
+ */
+size_t getWorkerCount(const char *count) {
+  if (count[0] == '\0') {
+    return max(thread::hardware_concurrency(), 1u);
+  }
+  int workers = atoi(count);
+  if (workers <= 0) {
+    cout << "Invalid number of workers '" << count << "'. Aborting.";
+    exit(1);
+  }
+  return workers;
+}
+
 void loadAllFilesFromDir(string dirname) {
   vector<string> filesInDir = Util::getFilesInDirectory(dirname);
   for (string file : filesInDir) {
@@ -154,8 +304,11 @@ string getFilenameOut() {
   }
 }
 
-void saveSourceToFile(string filenameOut) {
-  string source = Parser::parse(filenames, outputChars, inputChars, rawInput);
+string getSource() {
+  return Parser::parse(filenames, outputChars, inputChars, rawInput, binary);
+}
+
+void saveSourceToFile(string source, string filenameOut) {
   ofstream out(filenameOut);
   out << source;
   out.close();
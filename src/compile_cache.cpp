@@ -0,0 +1,127 @@
+#include "compile_cache.hpp"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace std;
+
+/*
+ * FNV-1a hash of the source and the command, as a hexadecimal string.
+ * Source already contains the code and data of all programs in the chain,
+ * and reflects the I/O options.
+ */
+string CompileCache::getKey(const string &source, const string &command) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : source + '\0' + command) {
+    hash = (hash ^ (uint8_t) c) * 1099511628211ull;
+  }
+  char key[17];
+  snprintf(key, sizeof(key), "%016llx", (unsigned long long) hash);
+  return key;
+}
+
+/*
+ * Copies cached executable to 'filenameOut'. Returns 'false' if it isn't
+ * cached, or if the cached one was built from a different source or with
+ * a different command.
+ */
+bool CompileCache::fetch(const string &source, const string &command,
+                         const string &filenameOut) {
+  string dir = getDir();
+  if (dir == "") {
+    return false;
+  }
+  string path = dir+"/"+getKey(source, command);
+  string cachedInput;
+  if (!readFile(path+".key", cachedInput) ||
+      cachedInput != source + '\0' + command) {
+    return false;
+  }
+  return copyFile(path, filenameOut);
+}
+
+/*
+ * Files get written under a temporary name and then renamed, so that
+ * concurrent compiles never see a partially written file. Key file is
+ * renamed last, so executable is never used before it is complete.
+ */
+void CompileCache::store(const string &source, const string &command,
+                         const string &filenameOut) {
+  string dir = getDir();
+  if (dir == "") {
+    return;
+  }
+  string path = dir+"/"+getKey(source, command);
+  string tmpName = path+".tmp"+to_string(getpid());
+  string tmpKeyName = path+".key.tmp"+to_string(getpid());
+  // Stale key file must not match the new executable while it is replaced.
+  remove((path+".key").c_str());
+  if (copyFile(filenameOut, tmpName) &&
+      writeFile(tmpKeyName, source + '\0' + command)) {
+    rename(tmpName.c_str(), path.c_str());
+    rename(tmpKeyName.c_str(), (path+".key").c_str());
+  } else {
+    remove(tmpName.c_str());
+    remove(tmpKeyName.c_str());
+  }
+}
+
+/*
+ * Returns empty string if directory doesn't exist and can't be created.
+ */
+string CompileCache::getDir() {
+  string base;
+  const char *xdgCacheHome = getenv("XDG_CACHE_HOME");
+  const char *home = getenv("HOME");
+  if (xdgCacheHome != NULL && xdgCacheHome[0] != '\0') {
+    base = xdgCacheHome;
+  } else if (home != NULL && home[0] != '\0') {
+    base = string(home)+"/.cache";
+  } else {
+    return "";
+  }
+  mkdir(base.c_str(), 0755);
+  string dir = base+"/comp";
+  if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+    return "";
+  }
+  return dir;
+}
+
+bool CompileCache::copyFile(const string &from, const string &to) {
+  ifstream in(from, ios::binary);
+  if (!in) {
+    return false;
+  }
+  ofstream out(to, ios::binary | ios::trunc);
+  out << in.rdbuf();
+  out.close();
+  if (!out) {
+    return false;
+  }
+  return chmod(to.c_str(), 0755) == 0;
+}
+
+bool CompileCache::readFile(const string &filename, string &contents) {
+  ifstream in(filename, ios::binary);
+  if (!in) {
+    return false;
+  }
+  contents = string(istreambuf_iterator<char>(in),
+                    istreambuf_iterator<char>());
+  return !in.bad();
+}
+
+bool CompileCache::writeFile(const string &filename, const string &contents) {
+  ofstream out(filename, ios::binary | ios::trunc);
+  out << contents;
+  out.close();
+  return !out.fail();
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef COMPILE_CACHE_H
+#define COMPILE_CACHE_H
+
+#include <string>
+
+using namespace std;
+
+/*
+ * Keeps executables built by 'compile' command in '$XDG_CACHE_HOME/comp'
+ * (or '~/.cache/comp'), named by the hash of their source and the compiler
+ * command, so unchanged programs don't need to be compiled again. Source
+ * and command are kept in a file next to the executable, and get compared
+ * before it is reused, in case two programs have the same hash.
+ */
+class CompileCache {
+  public:
+    static string getKey(const string &source, const string &command);
+    static bool fetch(const string &source, const string &command,
+                      const string &filenameOut);
+    static void store(const string &source, const string &command,
+                      const string &filenameOut);
+
+  private:
+    static string getDir();
+    static bool copyFile(const string &from, const string &to);
+    static bool readFile(const string &filename, string &contents);
+    static bool writeFile(const string &filename, const string &contents);
+};
+
+#endif
\ No newline at end of file
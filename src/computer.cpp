@@ -1,13 +1,36 @@
 #include "computer.hpp"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <vector>
 
+#include "byte_filter.hpp"
 #include "comp.hpp"
+#include "const.hpp"
 #include "cpu.hpp"
+#include "engine.hpp"
+#include "loop_detector.hpp"
+#include "machine_state.hpp"
+#include "parallel_chain.hpp"
 #include "ram.hpp"
+#include "scheduler.hpp"
+#include "transition_cache.hpp"
 
-vector<bool> Computer::getOutput() {
+int Computer::getOutput() {
+  // Noninteractive mode doesn't need to be stopped after every cycle.
+  if (printState == NULL) {
+    if (!filterChecked) {
+      filterChecked = true;
+      isFilter = byteFilter.compile(cpu, ram);
+    }
+    if (isFilter) {
+      return filterInput();
+    }
+    if (memoize) {
+      return runMemoizedUntilOutput();
+    }
+    return runUntilOutput();
+  }
   while(!executionCanceled) {
     bool shouldContinue = cpu.step();
     if (ram.outputPending) {
@@ -17,7 +40,7 @@ vector<bool> Computer::getOutput() {
     if (printState != NULL) {
       printState();
       if (!shouldContinue) {
-        return { };
+        return NO_OUTPUT;
       }
       sleepAndCheckForKey();
     }
@@ -25,5 +48,210 @@ vector<bool> Computer::getOutput() {
       exit(0);
     }
   }
-  return { };
+  return NO_OUTPUT;
+}
+
+/*
+ * Runs the program with the selected engine until it outputs a word. Stops
+ * now and then to check if program got stuck in a loop, and to let other
+ * fibers run.
+ */
+int Computer::runUntilOutput() {
+  if (!loopOutput.empty()) {
+    return repeatLoopOutput();
+  }
+  if (tiered && cpu.engine == INTERPRETER_ENGINE) {
+    if (!interpretUntilPromoted()) {
+      ram.outputPending = false;
+      return ram.output;
+    }
+  }
+  while (true) {
+    unsigned long inputCount = ram.inputCount;
+    RunResult result = cpu.run(LOOP_CHECK_JUMPS);
+    if (result == RUN_STOPPED) {
+      ParallelChain::stop(NO_OUTPUT);
+    }
+    int outputWord = NO_OUTPUT;
+    if (result == RUN_OUTPUT) {
+      ram.outputPending = false;
+      outputWord = ram.output;
+    }
+    bool inputRead = ram.inputCount != inputCount;
+    if (loopDetector.check(cpu.getState(), inputRead, outputWord)) {
+      startRepeatingLoop();
+    }
+    if (outputWord != NO_OUTPUT) {
+      return outputWord;
+    }
+    if (!loopOutput.empty()) {
+      return repeatLoopOutput();
+    }
+    Scheduler::yield();
+  }
+}
+
+/*
+ * Memoizing version of 'runUntilOutput()'. Program is interpreted until it
+ * is about to read input, and the resulting transition gets cached, so
+ * next time program is in the same state, the interpreting can be skipped.
+ * The instruction that reads input always gets executed.
+ */
+int Computer::runMemoizedUntilOutput() {
+  while (pendingOutputIndex == pendingOutput.size()) {
+    if (!loopOutput.empty()) {
+      return repeatLoopOutput();
+    }
+    if (stopped) {
+      ParallelChain::stop(NO_OUTPUT);
+    }
+    takeTransition();
+    Scheduler::yield();
+  }
+  return pendingOutput[pendingOutputIndex++];
+}
+
+void Computer::takeTransition() {
+  unsigned long inputCount = ram.inputCount;
+  pendingOutput.clear();
+  pendingOutputIndex = 0;
+  // Input is read only after the output of previous transition was
+  // returned, because reaching the end of input exits the program.
+  if (inputPending) {
+    inputPending = false;
+    cpu.step();
+    if (ram.outputPending) {
+      ram.outputPending = false;
+      pendingOutput.push_back(ram.output);
+    }
+  }
+  MachineState state = cpu.getState();
+  const Transition *transition = transitionCache.get(state);
+  if (transition == NULL) {
+    Transition recorded;
+    recorded.result = cpu.runUntilInput(MEMO_STEPS, recorded.output);
+    recorded.next = cpu.getState();
+    transition = transitionCache.put(state, recorded);
+  }
+  cpu.setState(transition->next);
+  pendingOutput.insert(pendingOutput.end(), transition->output.begin(),
+                       transition->output.end());
+  if (transition->result == RUN_STOPPED) {
+    stopped = true;
+    return;
+  }
+  inputPending = transition->result == RUN_INPUT;
+  bool inputRead = ram.inputCount != inputCount;
+  if (loopDetector.check(cpu.getState(), inputRead, pendingOutput)) {
+    startRepeatingLoop();
+  }
+}
+
+/*
+ * Used instead of running the program, if it is a byte filter. Reads a
+ * word from input and returns the word from filter's table.
+ */
+int Computer::filterInput() {
+  if (prologueIndex < byteFilter.prologueOutput.size()) {
+    return byteFilter.prologueOutput[prologueIndex++];
+  }
+  ram.inputCount++;
+  uint8_t word = ram.input->getOutput();
+  return byteFilter.apply(word);
+}
+
+/*
+ * Puts the program back into the passed state, as if it never ran. Byte
+ * filter table, transition cache and generated code are kept, since they
+ * only depend on the program.
+ */
+void Computer::restart(const MachineState &state) {
+  cpu.setState(state);
+  ram.outputPending = false;
+  ram.inputCount = 0;
+  loopDetector = LoopDetector();
+  loopOutput.clear();
+  loopOutputIndex = 0;
+  pendingOutput.clear();
+  pendingOutputIndex = 0;
+  inputPending = false;
+  stopped = false;
+  prologueIndex = 0;
+}
+
+/*
+ * Profiled or traced program always runs in the interpreter and is never
+ * replaced by a filter table, transitions or repeated loop output, so no
+ * instruction gets skipped.
+ */
+void Computer::interpretEveryInstruction() {
+  setEngine(INTERPRETER_ENGINE);
+  memoize = false;
+  repeatLoops = false;
+  filterChecked = true;
+  isFilter = false;
+}
+
+void Computer::setEngine(Engine engine) {
+  tiered = engine == TIERED_ENGINE;
+  if (tiered) {
+    cpu.engine = INTERPRETER_ENGINE;
+  } else {
+    cpu.engine = engine;
+  }
+}
+
+void Computer::enableProfiling(Profile *profile) {
+  cpu.profile = profile;
+  interpretEveryInstruction();
+}
+
+void Computer::enableTracing(TraceBuffer *trace) {
+  cpu.trace = trace;
+  interpretEveryInstruction();
+}
+
+/*
+ * Interprets the program until it outputs a word, in which case it returns
+ * 'false', or until it executes enough instructions to get promoted to the
+ * JIT engine. Promotion happens between two instructions, so the JIT
+ * continues where the interpreter stopped.
+ */
+bool Computer::interpretUntilPromoted() {
+  while (interpretedCycles < TIER_UP_CYCLES) {
+    bool shouldContinue = cpu.step();
+    interpretedCycles++;
+    if (ram.outputPending) {
+      return false;
+    }
+    if (!shouldContinue) {
+      ParallelChain::stop(NO_OUTPUT);
+    }
+  }
+  cpu.engine = JIT_ENGINE;
+  return true;
+}
+
+/*
+ * Program got into a state it was already in, without reading any input in
+ * between. It will therefore repeat the same output forever, or hang if
+ * the loop doesn't produce any. If loops don't get repeated, program keeps
+ * running and the detector starts over.
+ */
+void Computer::startRepeatingLoop() {
+  if (loopDetector.getLoopOutput().empty()) {
+    ParallelChain::stopStuck(name);
+  }
+  if (!repeatLoops) {
+    loopDetector = LoopDetector();
+    return;
+  }
+  loopOutput = loopDetector.getLoopOutput();
+  loopOutputIndex = 0;
+}
+
+int Computer::repeatLoopOutput() {
+  uint8_t word = loopOutput[loopOutputIndex];
+  loopOutputIndex = (loopOutputIndex + 1) % loopOutput.size();
+  return word;
 }
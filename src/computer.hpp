@@ -1,11 +1,18 @@
 #ifndef COMPUTER_H
 #define COMPUTER_H
 
+#include <stdint.h>
+#include <string>
 #include <vector>
 
+#include "byte_filter.hpp"
 #include "cpu.hpp"
+#include "engine.hpp"
+#include "loop_detector.hpp"
+#include "machine_state.hpp"
 #include "provides_output.hpp"
 #include "ram.hpp"
+#include "transition_cache.hpp"
 
 using namespace std;
 
@@ -22,16 +29,57 @@ class Computer : public ProvidesOutput {
           printState(printStateIn),
           sleepAndCheckForKey(sleepAndCheckForKeyIn) { }
     
-    vector<bool> getOutput();
+    int getOutput();
+    void setEngine(Engine engine);
+    void enableProfiling(Profile *profile);
+    void enableTracing(TraceBuffer *trace);
+    void restart(const MachineState &state);
 
     // Main components.
     Ram ram;
     Cpu cpu;
+    // Used in error messages.
+    string name;
+    // Looks up stretches of execution between input reads in the
+    // transition cache, instead of executing them again.
+    bool memoize = false;
 
   private:
     // Print state function pointer.
     void (*printState)(void);
     void (*sleepAndCheckForKey)(void);
+    // With tiered engine the program starts in the interpreter, and gets
+    // promoted to JIT after executing TIER_UP_CYCLES instructions.
+    bool tiered = false;
+    long interpretedCycles = 0;
+    // Once program gets into a loop, the output of the loop gets repeated
+    // instead of running the program.
+    bool repeatLoops = true;
+    LoopDetector loopDetector;
+    vector<uint8_t> loopOutput;
+    size_t loopOutputIndex = 0;
+    // Used in memoizing mode. Output of one transition can hold multiple
+    // words, that get returned one by one.
+    TransitionCache transitionCache;
+    vector<uint8_t> pendingOutput;
+    size_t pendingOutputIndex = 0;
+    bool inputPending = false;
+    bool stopped = false;
+    // Program that is a function of the input word gets replaced by a
+    // table, before it starts running.
+    ByteFilter byteFilter;
+    bool filterChecked = false;
+    bool isFilter = false;
+    size_t prologueIndex = 0;
+
+    int runUntilOutput();
+    int runMemoizedUntilOutput();
+    void takeTransition();
+    int filterInput();
+    bool interpretUntilPromoted();
+    void startRepeatingLoop();
+    int repeatLoopOutput();
+    void interpretEveryInstruction();
 };
 
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef CONST_H
 #define CONST_H
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 #include <set>
@@ -24,6 +25,65 @@ const int INIT_OPERAND_INDEX = 1;
 const int AND_OPERAND_INDEX = 2;
 const int OR_OPERAND_INDEX = 3;
 
+// Number of instructions that tiered engine interprets, before it compiles
+// the program with JIT.
+const long TIER_UP_CYCLES = 10000;
+
+// Number of jumps that engine executes before computer checks whether
+// program got into an endless loop.
+const long LOOP_CHECK_JUMPS = 1 << 16;
+// Loop detection gives up and starts over if loop is longer than this
+// number of checks.
+const long MAX_LOOP_CHECKS = 1 << 20;
+
+// Max number of instructions in one transition of memoizing mode, and max
+// number of transitions that a computer remembers.
+const long MEMO_STEPS = 1 << 12;
+const size_t MAX_CACHED_TRANSITIONS = 1 << 16;
+
+// Program doesn't get replaced by a byte filter table if it can get into
+// more than this many states before reading input, or if checking them
+// takes more than this many instructions.
+const size_t MAX_FILTER_STATES = 1 << 10;
+const int MAX_FILTER_CHECK_STEPS = 1 << 20;
+
+// Number of bytes that pipe input reads from stdin at once.
+const size_t INPUT_BUFFER_SIZE = 1 << 16;
+// Number of bytes that standard output collects before writing them out.
+const size_t OUTPUT_BUFFER_SIZE = 1 << 16;
+// Number of bytes by which output file grows when it fills up.
+const size_t MAPPED_OUTPUT_CHUNK = 1 << 26;
+// Number of words that fit between two computers of a parallel chain,
+// number of times a computer checks the buffer before it goes to sleep,
+// and number of microseconds that a join node of a topology sleeps when
+// none of its inputs has a word.
+const size_t RING_BUFFER_SIZE = 1 << 12;
+const int RING_SPIN_COUNT = 1 << 8;
+const int RING_SLEEP_MICROSECONDS = 1000;
+// Number of bytes reserved for the stack of each fiber. Pages only get
+// allocated once they are used.
+const size_t FIBER_STACK_SIZE = 1 << 18;
+
+// Number of records that batch mode reads before it starts processing
+// them, and max number of bytes that it prints for one record.
+const size_t BATCH_RECORDS = 1 << 12;
+const size_t MAX_BATCH_OUTPUT = 1 << 24;
+
+// Max number of loaded computers that server keeps for later requests,
+// max size of a program that it accepts, and max length of request's
+// header line.
+const size_t SERVER_CACHED_COMPUTERS = 1 << 8;
+const size_t SERVER_MAX_PROGRAM_SIZE = 1 << 20;
+const size_t SERVER_MAX_LINE = 1 << 10;
+
+// Number of records that each computer can trace before the background
+// thread writes them to the file, number of microseconds that the thread
+// sleeps when there is nothing to write, and max length of a line in the
+// header of a trace file.
+const size_t TRACE_BUFFER_RECORDS = 1 << 14;
+const int TRACE_FLUSH_MICROSECONDS = 1000;
+const size_t TRACE_MAX_LINE = 1 << 12;
+
 const string GCC_COMMAND = "g++ -std=c++11 -g -O2 -o";
 
 const bool BRIGHTEN_CURSOR = false;
@@ -35,21 +95,18 @@ const int WORD_SIZE = 8;
 const int ADDR_SIZE = 4;
 const int RAM_SIZE = 15;
 
-const vector<bool> EMPTY_WORD = { false, false, false, false, false, false,
-                                  false, false };
-const vector<bool> FIRST_ADDRESS = { false, false, false, false };
-const vector<bool> LAST_ADDRESS = { true, true, true, true };
-const vector<bool> ONE_BEFORE_LAST_ADDRESS = { true, true, true, false };
+const uint8_t EMPTY_WORD = 0;
+const uint8_t FIRST_ADDRESS = 0;
+const uint8_t LAST_ADDRESS = 15;
+const uint8_t ONE_BEFORE_LAST_ADDRESS = 14;
 const int MAX_VALUE = 255;
 
-const vector<bool> INIT_INSTRUCTION = { false, true, true, true, false, false,
-                                        true, false };
-const vector<bool> AND_INSTRUCTION = { false, true, true, true, false, true,
-                                       true, false };
-const vector<bool> OR_INSTRUCTION = { false, true, true, true, false, true,
-                                      true, true };
-const vector<bool> LAST_XOR_INSTRUCTION = { false, true, true, true, true, true,
-                                            true, true };
+// Words are stored MSB first, so '-***--*-' is 0x72.
+const uint8_t INIT_INSTRUCTION = 0x72;      // -***--*-
+const uint8_t AND_INSTRUCTION = 0x76;       // -***-**-
+const uint8_t OR_INSTRUCTION = 0x77;        // -***-***
+const uint8_t FIRST_XOR_INSTRUCTION = 0x78; // -****---
+const uint8_t LAST_XOR_INSTRUCTION = 0x7f;  // -*******
 const int LAST_XOR_OPERAND_INDEX = 7;                                  
 
 const int PRINTER_WIDTH = 12;
@@ -90,19 +147,21 @@ const string ESCAPE = u8"\u001B";
 const string LOWERCASE_M = u8"\u006D";
 
 const string SOURCE_INCLUDES= ""
+"#include <ctype.h>\n"
+"#include <errno.h>\n"
 "#include <stdio.h>\n"
 "#include <stdlib.h>\n"
+"#include <string.h>\n"
 "#include <unistd.h>\n"
 "\n"
-"#include <bitset>\n"
-"#include <iostream>\n"
-"#include <string>";
-
+"#include <algorithm>";
 
 const string SOURCE_HEADER = ""
 "using namespace std;\n"
 "\n"
 "bool outputNumbers = false;\n"
+"// Output gets written after every word if it goes to a terminal.\n"
+"bool flushEagerly = false;\n"
 "\n"
 "unsigned char sadd(unsigned char a, unsigned char b) {\n"
 "  return (a > 255 - b) ? 255 : a + b;\n"
@@ -112,97 +171,144 @@ const string SOURCE_HEADER = ""
 "  return (b > a) ? 0 : a - b;\n"
 "}\n"
 "\n"
-"unsigned char extractInteger(string line) {\n"
-"  int i = 0;\n"
-"  for (char c : line) {\n"
-"    if (!isdigit(c)) {\n"
+"// Input and output are read and written in blocks.\n"
+"unsigned char inBuffer[1 << 16];\n"
+"size_t inPosition = 0;\n"
+"size_t inLength = 0;\n"
+"char outBuffer[1 << 16];\n"
+"size_t outLength = 0;\n"
+"\n"
+"void flushOutput() {\n"
+"  size_t written = 0;\n"
+"  while (written < outLength) {\n"
+"    ssize_t num = write(1, outBuffer + written, outLength - written);\n"
+"    if (num == -1) {\n"
+"      if (errno == EINTR) {\n"
+"        continue;\n"
+"      }\n"
 "      break;\n"
 "    }\n"
-"    i++;\n"
+"    written += num;\n"
 "  }\n"
-"  string stringNumber = line.substr(0, i);\n"
-"  return (unsigned char) stoi(stringNumber, NULL);\n"
+"  outLength = 0;\n"
 "}\n"
 "\n"
-"unsigned char getBoolByte(string sIn) {\n"
-"  string sOut;\n"
-"  for (char c : sIn) {\n"
-"    if (c == '*') {\n"
-"      sOut.push_back('1');\n"
-"    } else {"
-"      sOut.push_back('0');\n"
-"    }\n"
+"void printBytes(const char *bytes, size_t count) {\n"
+"  if (outLength + count > sizeof(outBuffer)) {\n"
+"    flushOutput();\n"
 "  }\n"
-"  return (unsigned char) stoi(sOut, NULL, 2);\n"
-"}\n"
-"\n"
-"unsigned char parseWord(string word) {\n"
-"  bool startsWithDigit = isdigit(word[0]);\n"
-"  if (startsWithDigit) {\n"
-"    return extractInteger(word);\n"
-"  } else {\n"
-"    return getBoolByte(word);\n"
+"  memcpy(outBuffer + outLength, bytes, count);\n"
+"  outLength += count;\n"
+"  if (flushEagerly) {\n"
+"    flushOutput();\n"
 "  }\n"
 "}\n"
 "\n"
-"string getString(unsigned char c) {\n"
-"  std::bitset<8> x(c);\n"
-"  string out;\n"
-"  for (size_t i = 0; i < 8; i++) {\n"
-"    if (x[i]) {\n"
-"      out += \"*\";\n"
-"    } else {\n"
-"      out += \"-\";\n"
+"// Output is flushed before waiting for input.\n"
+"int readByte() {\n"
+"  if (inPosition == inLength) {\n"
+"    flushOutput();\n"
+"    ssize_t num;\n"
+"    do {\n"
+"      num = read(0, inBuffer, sizeof(inBuffer));\n"
+"    } while (num == -1 && errno == EINTR);\n"
+"    if (num <= 0) {\n"
+"      return EOF;\n"
 "    }\n"
+"    inPosition = 0;\n"
+"    inLength = num;\n"
 "  }\n"
-"  return out;\n"
+"  return inBuffer[inPosition++];\n"
 "}\n"
 "\n"
-"string getFormatedInt(unsigned char c) {\n"
-"  char formatedInt [4];\n"
-"  sprintf(formatedInt, \"%3d\", c);\n"
-"  return formatedInt;\n"
-"}\n"
+"// Text of each word, MSB first, optionally followed by its value.\n"
+"char wordLines[256][16];\n"
+"size_t wordLengths[256];\n"
 "\n"
-"string getStringWithFormatedInt(unsigned char c) {\n"
-"  return getString(c) + \" \" + getFormatedInt(c) + \"\\n\";\n"
+"void initWordLines() {\n"
+"  for (int c = 0; c < 256; c++) {\n"
+"    char *line = wordLines[c];\n"
+"    for (int i = 0; i < 8; i++) {\n"
+"      line[i] = (c & (0x80 >> i)) ? '*' : '-';\n"
+"    }\n"
+"    if (outputNumbers) {\n"
+"      wordLengths[c] = 8 + sprintf(line + 8, \" %3d\\n\", c);\n"
+"    } else {\n"
+"      line[8] = '\\n';\n"
+"      wordLengths[c] = 9;\n"
+"    }\n"
+"  }\n"
 "}";
 
 const string PRINT_BASIC = ""
 "void print(unsigned char c) {\n"
-"  if (outputNumbers) {\n"
-"    cout << getStringWithFormatedInt(c);\n"
-"  } else {\n"
-"    cout << getString(c) + \"\\n\";\n"
-"  }\n"
+"  printBytes(wordLines[c], wordLengths[c]);\n"
 "}";
 
 const string PRINT_OUTPUT_CHARS = ""
 "void print(unsigned char c) {\n"
-"  cout << c;\n"
+"  if (outLength == sizeof(outBuffer)) {\n"
+"    flushOutput();\n"
+"  }\n"
+"  outBuffer[outLength++] = c;\n"
+"  if (flushEagerly) {\n"
+"    flushOutput();\n"
+"  }\n"
 "}";
 
+const string PRINT_BINARY = PRINT_OUTPUT_CHARS;
+
 const string PRINT_RAW = ""
 "void print(unsigned char c) {\n"
-"  cout << c;\n"
+"  putchar(c);\n"
 "  fflush(stdout);\n"
 "}";
 
 const string F0_BASIC = ""
+"// Numbers larger than max value get saturated. Otherwise every '*' is\n"
+"// interpreted as true and all other characters as false.\n"
 "unsigned char f0() {\n"
-"  string word;\n"
-"  cin >> word;\n"
-"  if (!cin) {\n"
+"  int c = readByte();\n"
+"  while (isspace(c)) {\n"
+"    c = readByte();\n"
+"  }\n"
+"  if (c == EOF) {\n"
 "    exit(0);\n"
 "  }\n"
-"  return parseWord(word);\n"
+"  int out = 0;\n"
+"  if (isdigit(c)) {\n"
+"    while (isdigit(c)) {\n"
+"      out = min(out * 10 + c - '0', 255);\n"
+"      c = readByte();\n"
+"    }\n"
+"  } else {\n"
+"    for (int i = 0; i < 8 && c != EOF && !isspace(c); i++) {\n"
+"      if (c == '*') {\n"
+"        out |= 0x80 >> i;\n"
+"      }\n"
+"      c = readByte();\n"
+"    }\n"
+"  }\n"
+"  while (c != EOF && !isspace(c)) {\n"
+"    c = readByte();\n"
+"  }\n"
+"  return out;\n"
 "}";
 
 const string F0_INPUT_CHARS = ""
 "unsigned char f0() {\n"
-"  int c = getchar();\n"
+"  int c = readByte();\n"
+"  if (c == EOF) {\n"
+"    printBytes(\"\\n\", 1);\n"
+"    exit(0);\n"
+"  }\n"
+"  return (unsigned char) c;\n"
+"}";
+
+const string F0_BINARY = ""
+"unsigned char f0() {\n"
+"  int c = readByte();\n"
 "  if (c == EOF) {\n"
-"    cout << endl;\n"
 "    exit(0);\n"
 "  }\n"
 "  return (unsigned char) c;\n"
@@ -223,43 +329,29 @@ const string F0_RAW = ""
 "  return c;\n"
 "}";
 
-const string SOURCE_FOOTER_1 = ""
+// All computers are converted into this function. It never returns.
+const string SOURCE_RUN_HEADER = ""
+"void run() {\n"
+"  // Word that is passed from one computer to the next.\n"
+"  unsigned char word;\n";
+
+const string SOURCE_FOOTER = ""
 "int main() {\n"
 "  outputNumbers = isatty(fileno(stdout));\n"
-"  while(1) {\n"
-"    print(f";
+"  flushEagerly = outputNumbers;\n"
+"  initWordLines();\n"
+"  atexit(flushOutput);\n"
+"  run();\n"
+"}";
 
-const string SOURCE_FOOTER_1_RAW = ""
+const string SOURCE_FOOTER_RAW = ""
 "int main() {\n"
 "  setEnvironment();\n"
 "  outputNumbers = isatty(fileno(stdout));\n"
-"  while(1) {\n"
-"    print(f";
-
-const string SOURCE_FOOTER_2 = "());\n"
-"  }\n"
-"}";
-
-const string SOURCE_FUNCTION_HEADER_1 = "unsigned char f";
-
-const string SOURCE_FUNCTION_HEADER_2 = "() {\n"
-"  static unsigned char (*predecesor)() = &f";
-
-const string SOURCE_FUNCTION_HEADER_3 = ";\n"
-"  static void *a[16] = { &&a00, &&a01, &&a02, &&a03, &&a04, &&a05,\n"
-"                              &&a06, &&a07, &&a08, &&a09, &&a10, &&a11,\n" 
-"                              &&a12, &&a13, &&a14, &&a15 };\n"
-"  static unsigned char reg = 0;\n"
-"  static unsigned char pc = 0;\n"
-"  static unsigned char adr = 0;\n"
-"  static unsigned char data[15] = { ";
-
-const string SOURCE_FUNCTION_HEADER_4 = " };\n"
-"\n"
-"  goto *a[pc];";
-
-const string SOURCE_FUNCTION_FOOTER = ""
-"  a15: exit(0);\n"
+"  flushEagerly = outputNumbers;\n"
+"  initWordLines();\n"
+"  atexit(flushOutput);\n"
+"  run();\n"
 "}";
 
 #endif
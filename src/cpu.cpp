@@ -1,12 +1,14 @@
 #include "cpu.hpp"
 
-#include <cmath>
 #include <string>
 #include <vector>
-#include <set>
 
 #include "address.hpp"
+#include "input_probe.hpp"
 #include "instruction.hpp"
+#include "isa.hpp"
+#include "machine_state.hpp"
+#include "provides_output.hpp"
 #include "util.hpp"
 
 using namespace std;
@@ -16,44 +18,188 @@ using namespace std;
  */
 bool Cpu::step() {
   cycle++;
-  bool reachedLastAddress = Util::getInt(pc) >= RAM_SIZE;
+  bool reachedLastAddress = pc >= RAM_SIZE;
   if (reachedLastAddress) {
     return false;
   }
-  Instruction inst = getInstruction();
-  inst.exec(pc, reg, ram);
+  if (!programDecoded) {
+    decodeProgram();
+  }
+  const DecodedInstruction &inst = program[pc];
+  Address adr = Isa::getAddress(inst.opcode, inst.firstOrderAdr, reg, &ram);
+  Isa::get(inst.opcode).exec(adr, pc, reg, ram);
   return true;
 }
 
+/*
+ * Executes instructions with the selected engine, until a word is sent to
+ * the output, last address is reached, or the next instruction is a jump
+ * and 'budget' jumps were already executed.
+ */
+RunResult Cpu::run(long budget) {
+  if (!programDecoded) {
+    decodeProgram();
+  }
+  if (profile != NULL || trace != NULL) {
+    return runInstrumented(budget);
+  }
+  if (engine == INTERPRETER_ENGINE) {
+    while (true) {
+      bool isJump = pc < RAM_SIZE && Isa::isJump(program[pc].opcode);
+      if (isJump && budget-- == 0) {
+        return RUN_BUDGET_SPENT;
+      }
+      if (!step()) {
+        return RUN_STOPPED;
+      }
+      if (ram.outputPending) {
+        return RUN_OUTPUT;
+      }
+    }
+  }
+  // Falls back to threaded engine if JIT is not supported on this platform.
+  if (engine == JIT_ENGINE && JitEngine::isAvailable()) {
+    return jitEngine.run(pc, reg, ram, budget);
+  }
+  return threadedEngine.run(pc, reg, ram, budget);
+}
+
+/*
+ * Same as the interpreter loop in 'run()', but also tells the profile about
+ * every executed instruction and I/O event, and records the instructions
+ * in the trace.
+ */
+RunResult Cpu::runInstrumented(long budget) {
+  while (true) {
+    if (pc >= RAM_SIZE) {
+      cycle++;
+      return RUN_STOPPED;
+    }
+    const DecodedInstruction &inst = program[pc];
+    if (Isa::isJump(inst.opcode) && budget-- == 0) {
+      return RUN_BUDGET_SPENT;
+    }
+    unsigned long inputCount = ram.inputCount;
+    cycle++;
+    Address adr = Isa::getAddress(inst.opcode, inst.firstOrderAdr, reg, &ram);
+    if (profile != NULL) {
+      profile->countInstruction(pc, inst.opcode, inst.firstOrderAdr, adr);
+    }
+    if (trace != NULL) {
+      trace->push(cycle, pc, ram.state[CODE][pc], reg, adr);
+    }
+    Isa::get(inst.opcode).exec(adr, pc, reg, ram);
+    bool io = ram.inputCount != inputCount || ram.outputPending;
+    if (profile != NULL && io) {
+      profile->countIo();
+    }
+    if (ram.outputPending) {
+      return RUN_OUTPUT;
+    }
+  }
+}
+
+/*
+ * Interprets the program until the next instruction would read from the
+ * input, last address is reached, or 'steps' instructions are executed.
+ * Words sent to the output get appended to 'outputWords'. Instruction that
+ * reads input is not executed.
+ */
+RunResult Cpu::runUntilInput(long steps, vector<uint8_t> &outputWords) {
+  InputProbe probe;
+  ProvidesOutput *input = ram.input;
+  ram.input = &probe;
+  RunResult result = RUN_BUDGET_SPENT;
+  for (long i = 0; i < steps; i++) {
+    MachineState stateBefore = getState();
+    unsigned long inputCount = ram.inputCount;
+    bool shouldContinue = step();
+    if (probe.wasRead) {
+      // Takes back the instruction, so it can be executed with real input.
+      setState(stateBefore);
+      ram.inputCount = inputCount;
+      ram.outputPending = false;
+      cycle--;
+      result = RUN_INPUT;
+      break;
+    }
+    if (!shouldContinue) {
+      result = RUN_STOPPED;
+      break;
+    }
+    if (ram.outputPending) {
+      ram.outputPending = false;
+      outputWords.push_back(ram.output);
+    }
+  }
+  ram.input = input;
+  return result;
+}
+
 void Cpu::reset() {
-  reg = vector<bool>(WORD_SIZE);
-  pc = vector<bool>(ADDR_SIZE);
+  reg = 0;
+  pc = 0;
   cycle = 0;
+  programDecoded = false;
 }
 
 Instruction Cpu::getInstruction() const {
-  Address adr = Address(CODE, pc);
-  vector<bool> instructionWord = ram.get(adr);
+  uint8_t instructionWord = ram.get(Address(CODE, pc));
   return Instruction(instructionWord, reg, &ram);
 }
 
-vector<bool> Cpu::getRegister() const {
+uint8_t Cpu::getRegisterValue() const {
   return reg;
 }
 
-vector<bool> Cpu::getPc() const {
+uint8_t Cpu::getPcValue() const {
   return pc;
 }
 
-int Cpu::getCycle() const {
-  return cycle;
+vector<bool> Cpu::getRegister() const {
+  return Util::getBoolByte(reg);
 }
 
-void Cpu::switchOn() {
-  cycle = 1;
+vector<bool> Cpu::getPc() const {
+  return Util::getBoolNibb(pc);
 }
 
+int Cpu::getCycle() const {
+  return cycle;
+}
 
+MachineState Cpu::getState() const {
+  return { pc, reg, ram.state[DATA] };
+}
 
+void Cpu::setState(const MachineState &state) {
+  pc = state.pc;
+  reg = state.reg;
+  ram.state[DATA] = state.data;
+}
 
+/*
+ * Code can only be changed by the editor while computer is off, so the
+ * program gets decoded again on the first step after switching on.
+ */
+void Cpu::switchOn() {
+  cycle = 1;
+  programDecoded = false;
+}
 
+/*
+ * Running programs can't write to the code address space, so every code
+ * word needs to be decoded only once.
+ */
+void Cpu::decodeProgram() {
+  for (uint8_t i = 0; i < RAM_SIZE; i++) {
+    uint8_t word = ram.get(Address(CODE, i));
+    Opcode opcode = Isa::decode(word);
+    program[i] = { opcode, Isa::getFirstOrderAdr(opcode, word) };
+  }
+  threadedEngine.load(ram);
+  if (engine == JIT_ENGINE && JitEngine::isAvailable()) {
+    jitEngine.load(ram);
+  }
+  programDecoded = true;
+}
@@ -1,32 +1,73 @@
 #ifndef CPU_H
 #define CPU_H
 
+#include <array>
+#include <stdint.h>
 #include <vector>
 
+#include "address.hpp"
 #include "const.hpp"
+#include "engine.hpp"
+#include "isa.hpp"
+#include "jit_engine.hpp"
+#include "machine_state.hpp"
+#include "profile.hpp"
 #include "ram.hpp"
+#include "threaded_engine.hpp"
+#include "trace.hpp"
 
 using namespace std;
 
 class Instruction;
 
+/*
+ * Instruction as decoded from the code word. The effective address still
+ * gets resolved at execution, because it can depend on register or data.
+ */
+struct DecodedInstruction {
+  Opcode opcode;
+  Address firstOrderAdr;
+};
+
 class Cpu {
   public:
     Cpu(Ram &ramIn) : ram(ramIn) { }
     
     bool step();
+    RunResult run(long budget);
+    RunResult runUntilInput(long steps, vector<uint8_t> &outputWords);
     void reset();
     Instruction getInstruction() const;
+    uint8_t getRegisterValue() const;
+    uint8_t getPcValue() const;
+    // Unpacked versions, used by renderer.
     vector<bool> getRegister() const;
     vector<bool> getPc() const;
     int getCycle() const;
+    MachineState getState() const;
+    void setState(const MachineState &state);
     void switchOn();
 
+    // Engine that is used by 'run()'.
+    Engine engine = INTERPRETER_ENGINE;
+    // If any of them is set, 'run()' interprets the program and counts or
+    // records what it executes, regardless of the engine.
+    Profile *profile = NULL;
+    TraceBuffer *trace = NULL;
+
   private:
     Ram &ram;
-    vector<bool> reg = vector<bool>(WORD_SIZE);
-    vector<bool> pc = vector<bool>(ADDR_SIZE);
+    uint8_t reg = 0;
+    uint8_t pc = 0;
     int cycle = 0;
+    // Code words decoded once per run, indexed by pc.
+    array<DecodedInstruction, RAM_SIZE> program;
+    bool programDecoded = false;
+    ThreadedEngine threadedEngine;
+    JitEngine jitEngine;
+
+    void decodeProgram();
+    RunResult runInstrumented(long budget);
 };
 
 #endif
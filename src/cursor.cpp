@@ -8,7 +8,6 @@
 
 #include "const.hpp"
 #include "instruction.hpp"
-#include "specific_instruction.hpp"
 
 using namespace std;
 
@@ -41,8 +40,7 @@ AddrSpace Cursor::getAddressSpace() const {
 }
 
 Address Cursor::getAddress() const {
-  vector<bool> adrVal = Util::getBoolNibb(cursorPosition.at(addrSpace).at(Y));
-  return Address(addrSpace, adrVal);
+  return Address(addrSpace, cursorPosition.at(addrSpace).at(Y));
 }
 
 //////////////////////////////////
@@ -105,7 +103,7 @@ void Cursor::setByteIndex(int byteIndex) {
 void Cursor::goToAddress(Address adr) {
   addrSpace = adr.space;
   setBitIndex(0);
-  setByteIndex(Util::getInt(adr.val));
+  setByteIndex(adr.val);
 }
 
 void Cursor::goToEndOfWord() {
@@ -135,7 +133,7 @@ void Cursor::goToInstructionsAddress() {
   if (getAddressSpace() == DATA) {
     return;
   }
-  Instruction inst = Instruction(getWord(), EMPTY_WORD, &ram);
+  Instruction inst = Instruction(ram.get(getAddress()), EMPTY_WORD, &ram);
   if (inst.adr.space == NONE) {
     return;
   }
@@ -147,11 +145,17 @@ void Cursor::goToInstructionsAddress() {
 ////////////////////////////////
 
 bool Cursor::getBit() const {
-  return ram.state.at(addrSpace).at(getAddr()).at(getBitIndex());
+  uint8_t mask = 0x80 >> getBitIndex();
+  return ram.state[addrSpace].at(getAddr()) & mask;
 }
 
 void Cursor::setBit(bool bit) {
-  ram.state[addrSpace].at(getAddr()).at(getBitIndex()) = bit;
+  uint8_t mask = 0x80 >> getBitIndex();
+  if (bit) {
+    ram.state[addrSpace].at(getAddr()) |= mask;
+  } else {
+    ram.state[addrSpace].at(getAddr()) &= ~mask;
+  }
 }
 
 void Cursor::switchBit() {
@@ -160,15 +164,15 @@ void Cursor::switchBit() {
 }
 
 void Cursor::eraseByte() {
-  setWord(EMPTY_WORD);
+  ram.set(getAddress(), EMPTY_WORD);
 }
 
 vector<bool> Cursor::getWord() const {
-  return ram.get(getAddress());
+  return Util::getBoolByte(ram.get(getAddress()));
 }
 
 void Cursor::setWord(vector<bool> word) {
-  ram.set(getAddress(), word);
+  ram.set(getAddress(), Util::getInt(word));
 }
 
 void Cursor::moveByteUp() {
@@ -229,7 +233,7 @@ int Cursor::getIndexOfMovable(bool predecessor) {
       Instruction::getEffectiveInstructions(ram, EMPTY_WORD);
   if (predecessor) {
     for (int i = getY()-1; i >= 0; i--) {
-      Address iAdr = Address(addrSpace, Util::getBoolNibb(i));
+      Address iAdr = Address(addrSpace, i);
       if (adrMovableTo(curAdr, iAdr, instructions) &&
           adrMovableTo(iAdr, curAdr, instructions)) {
         return i;
@@ -238,7 +242,7 @@ int Cursor::getIndexOfMovable(bool predecessor) {
     return -1;
   } else {
     for (int i = getY()+1; i < RAM_SIZE; i++) {
-      Address iAdr = Address(addrSpace, Util::getBoolNibb(i));
+      Address iAdr = Address(addrSpace, i);
       if (adrMovableTo(curAdr, iAdr, instructions) &&
           adrMovableTo(iAdr, curAdr, instructions)) {
         return i;
@@ -253,8 +257,8 @@ int Cursor::getIndexOfMovable(bool predecessor) {
  */
 bool Cursor::adrMovableTo(Address &from, Address &to,  
                           vector<Instruction> &instructions) {
-  int fromIndex = Util::getInt(from.val);
-  int toIndex = Util::getInt(to.val);
+  int fromIndex = from.val;
+  int toIndex = to.val;
   bool indexOutOfBounds = toIndex < 0 || toIndex >= RAM_SIZE;
   bool invalidAddress = from.space == NONE;
   if (indexOutOfBounds || invalidAddress) {
@@ -287,8 +291,8 @@ bool Cursor::adrMovableTo(Address &from, Address &to,
       return true;
     }
     Instruction xorInstruction = 
-        Instruction( { false, true, true, true, true, from.val[1], from.val[2], 
-                       from.val[3]}, EMPTY_WORD, &ram);
+        Instruction(FIRST_XOR_INSTRUCTION | (from.val & 0x07), EMPTY_WORD,
+                    &ram);
     if (instructionExists(xorInstruction, instructions)) {
       if (toIndex > LAST_XOR_OPERAND_INDEX) {
         return false;
@@ -306,7 +310,7 @@ bool Cursor::insertByteAndMoveRestDown(Address adr) {
   if (!modifyTo) {
     return false;
   }
-  incOrDecAddressesInRange(adr.space, Util::getInt(adr.val), modifyTo, 1);
+  incOrDecAddressesInRange(adr.space, adr.val, modifyTo, 1);
   actuallyInsert(adr, modifyTo);
   return true;
 }
@@ -319,7 +323,7 @@ bool Cursor::deleteByteAndMoveRestUp(Address adr) {
   if (!modifyTo) {
     return false;
   }
-  incOrDecAddressesInRange(adr.space, Util::getInt(adr.val), modifyTo, -1);
+  incOrDecAddressesInRange(adr.space, adr.val, modifyTo, -1);
   actuallyDelete(adr, modifyTo);
   return true;
 }
@@ -330,7 +334,7 @@ bool Cursor::deleteByteAndMoveRestUp(Address adr) {
  */
 int Cursor::canModifyTo(bool insert, Address adr) {
   if (adr.space == DATA) {
-    int boundAdr = getFirstBoundDataAdr(insert, Util::getInt(adr.val));
+    int boundAdr = getFirstBoundDataAdr(insert, adr.val);
     if (boundAdr) {
       return canModifyDataWithBoundAdrTo(insert, boundAdr, adr);
     }
@@ -344,8 +348,8 @@ int Cursor::canModifyTo(bool insert, Address adr) {
 
 int Cursor::canModifyDataWithBoundAdrTo(bool insert, int boundAdr, Address adr) {
   if (insert) {
-    for (int i = boundAdr; i > Util::getInt(adr.val); i--) {
-      if (!addressUsed(Address(DATA, Util::getBoolNibb(i)))) {
+    for (int i = boundAdr; i > adr.val; i--) {
+      if (!addressUsed(Address(DATA, i))) {
         return i;
       }
     }
@@ -361,12 +365,11 @@ int Cursor::canModifyDataWithBoundAdrTo(bool insert, int boundAdr, Address adr)
 }
 
 int Cursor::canInsertTo(Address adr) {
-  Address lastAdr = Address(adr.space, Util::getBoolNibb(RAM_SIZE-1));
+  Address lastAdr = Address(adr.space, RAM_SIZE-1);
   bool adrUsed = addressUsed(lastAdr);
   if (adrUsed) {
     Address redundandAdr = getLastRedundandAdr(adr.space);
-    bool redundandAdrBeforAdr = Util::getInt(redundandAdr.val) <=
-                                Util::getInt(adr.val) + 1; 
+    bool redundandAdrBeforAdr = redundandAdr.val <= adr.val + 1; 
     if (redundandAdr.space == NONE || redundandAdrBeforAdr) {
       return 0;
     } else {
@@ -448,12 +451,12 @@ bool Cursor::instructionExists(Instruction &inst,
 
 Address Cursor::getLastRedundandAdr(AddrSpace addrSpaceIn) {
   for (int i = RAM_SIZE-2; i >= 1; i--) {
-    Address adr = Address(addrSpaceIn, Util::getBoolNibb(i));
+    Address adr = Address(addrSpaceIn, i);
     bool adrNotUsed = !addressUsed(adr);
     if (adrNotUsed) {
       if (addrSpaceIn == CODE) {
         bool valueBeforeNotEmpty = 
-            ram.get(Address(addrSpaceIn, Util::getBoolNibb(i-1))) != EMPTY_WORD;
+            ram.get(Address(addrSpaceIn, i-1)) != EMPTY_WORD;
         if (valueBeforeNotEmpty) {
           continue;
         }
@@ -471,17 +474,17 @@ void Cursor::incOrDecAddressesInRange(AddrSpace space, int indexStart,
   int indexOfLastInst = 
       Instruction::getIndexOfLastNonEmptyInst(allInstructions);
   for (int i = 0; i <= indexOfLastInst; i++) {
-    vector<bool> &word = ram.state[CODE].at(i);
+    uint8_t &word = ram.state[CODE].at(i);
     Instruction inst = Instruction(word, EMPTY_WORD, &ram);
     Address adr = inst.firstOrderAdr[0];
-    int adrVal = Util::getInt(adr.val);
+    int adrVal = adr.val;
     bool instPointingToSpace = adr.space == space;
     bool adrPastTheStart = adrVal >= indexStart;
     bool adrBeforeTheEnd = adrVal < indexEnd;
     bool notLastAdr = adr.val != LAST_ADDRESS;
     if (instPointingToSpace && adrPastTheStart && adrBeforeTheEnd && notLastAdr) {
       int newVal = adrVal + delta;
-      setAddress(word, newVal, inst.inst->getAdrIndex());
+      setAddress(word, newVal, inst.getAdrIndex());
     }
   }
 }
@@ -498,30 +501,33 @@ void Cursor::updateAddresses(AddrSpace space, int from, int to) {
   int indexOfLastInst = 
       Instruction::getIndexOfLastNonEmptyInst(allInstructions);
   for (int i = 0; i <= indexOfLastInst; i++) {
-    vector<bool> &word = ram.state[CODE].at(i);
+    uint8_t &word = ram.state[CODE].at(i);
     Instruction inst = Instruction(word, EMPTY_WORD, &ram);
     Address adr = inst.firstOrderAdr[0];
-    int adrVal = Util::getInt(adr.val);
+    int adrVal = adr.val;
     if (adr.space != space) {
       continue;
     }
     if (adrVal == from) {
-      setAddress(word, to, inst.inst->getAdrIndex());
+      setAddress(word, to, inst.getAdrIndex());
     } else if (adrVal == to) {
-      setAddress(word, from, inst.inst->getAdrIndex());
+      setAddress(word, from, inst.getAdrIndex());
     }
   }
 }
 
-void Cursor::setAddress(vector<bool> &word, int newAdrVal, int adrIndex) {
-  int adrLength = WORD_SIZE-adrIndex;
-  vector<bool> newAdr = Util::getBool(newAdrVal, adrLength);
-  word.erase(word.begin() + adrIndex, word.end());
-  word.insert(word.end(), newAdr.begin(), newAdr.end());
+/*
+ * Replaces bits of the word from 'adrIndex' on with the new address. The
+ * address gets saturated if it does not fit.
+ */
+void Cursor::setAddress(uint8_t &word, int newAdrVal, int adrIndex) {
+  int adrMask = (1 << (WORD_SIZE-adrIndex)) - 1;
+  int newAdr = min(max(newAdrVal, 0), adrMask);
+  word = (word & ~adrMask) | newAdr;
 }
 
 void Cursor::actuallyInsert(Address adr, int until) {
-  int adrVal = Util::getInt(adr.val);
+  int adrVal = adr.val;
   for (int i = until; i > adrVal; i--) {
     ram.state[adr.space][i] = ram.state[adr.space][i-1];
   }
@@ -529,14 +535,14 @@ void Cursor::actuallyInsert(Address adr, int until) {
 }
 
 void Cursor::actuallyDelete(Address adr, int until) {
-  for (int i = Util::getInt(adr.val); i < until; i++) {
+  for (int i = adr.val; i < until; i++) {
     ram.state[adr.space][i] = ram.state[adr.space][i+1];
   }
   ram.state[adr.space][until] = EMPTY_WORD;
 }
 
 void Cursor::actuallyMove(AddrSpace space, int from, int to) {
-  vector<bool> temp = ram.state[space][from];
+  uint8_t temp = ram.state[space][from];
   ram.state[space][from] = ram.state[space][to];
   ram.state[space][to] = temp;
 }
@@ -554,8 +560,7 @@ void Cursor::setAddr(int addr) {
 }
 
 void Cursor::changeBytesValue(int delta) {
-  vector<bool> val = getWord();
-  int intVal = Util::getInt(val) + delta;
-  setWord(Util::getBoolByte(intVal));
+  int intVal = ram.get(getAddress()) + delta;
+  ram.set(getAddress(), min(max(intVal, 0), MAX_VALUE));
 }
 
@@ -91,7 +91,7 @@ class Cursor {
     void swithcValuesAndReferences(AddrSpace space, int from, int to);
     void updateAddresses(AddrSpace space, int from, int to);
     Address getLastRedundandAdr(AddrSpace addrSpaceIn);
-    static void setAddress(vector<bool> &word, int val, int adrIndex);
+    static void setAddress(uint8_t &word, int val, int adrIndex);
     void actuallyInsert(Address adr, int until);
     void actuallyDelete(Address adr, int until);
     void actuallyMove(AddrSpace space, int from, int to);
@@ -9,7 +9,7 @@ using namespace std;
 // Automaticaly generated file from resources/drawing textfile.
 // Do not edit this line.
 
-const vector<string> drawing2D = {u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", 
+const char *const drawing2D[] = {u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", 
 u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", 
 u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", 
 u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0020", u8"\u0043", 
@@ -0,0 +1,14 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+// How computer executes its program in noninteractive mode. Tiered engine
+// starts with interpreter and switches to JIT once the program gets hot.
+enum Engine { INTERPRETER_ENGINE, THREADED_ENGINE, JIT_ENGINE,
+              TIERED_ENGINE };
+
+// Why engine stopped running. Values are also returned by the JIT code.
+// RUN_INPUT is only returned by 'Cpu::runUntilInput()'.
+enum RunResult { RUN_STOPPED = 0, RUN_OUTPUT = 1, RUN_BUDGET_SPENT = 2,
+                 RUN_INPUT = 3 };
+
+#endif
\ No newline at end of file
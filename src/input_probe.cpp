@@ -0,0 +1,8 @@
+#include "input_probe.hpp"
+
+using namespace std;
+
+int InputProbe::getOutput() {
+  wasRead = true;
+  return value;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef INPUT_PROBE_H
+#define INPUT_PROBE_H
+
+#include <stdint.h>
+
+#include "provides_output.hpp"
+
+using namespace std;
+
+/*
+ * Stands in for the real input, to find out whether an instruction reads
+ * from it. Always returns 'value'.
+ */
+class InputProbe : public ProvidesOutput {
+  public:
+    int getOutput();
+
+    bool wasRead = false;
+    uint8_t value = 0;
+};
+
+#endif
\ No newline at end of file
@@ -1,11 +1,13 @@
 #include "instruction.hpp"
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include "address.hpp"
 #include "const.hpp"
 #include "ram.hpp"
-#include "specific_instruction.hpp"
+#include "isa.hpp"
 #include "util.hpp"
 
 using namespace std;
@@ -14,23 +16,36 @@ using namespace std;
 /// INTERFACE ///
 /////////////////
 
-void Instruction::exec(vector<bool> &pc, vector<bool> &reg, Ram &ram) {
-  inst->exec(adr, pc, reg, ram);
-}
-
 bool Instruction::isLogic() {
   return index == LOGIC_OPS_INDEX;
 }
 
-string Instruction::getCode(int pc) {
-  return inst->getCode(firstOrderAdr[0], pc);
+int Instruction::getAdrIndex() {
+  return Isa::getAdrIndex(opcode);
+}
+
+/*
+ * Label of the instruction, followed by the address that is part of the
+ * instruction word, if any. Logic instructions share the label, so only
+ * their character is used.
+ */
+string Instruction::getText() {
+  string text = label;
+  if (isLogic()) {
+    text = text.substr(min(logicIndex, 8), 1);
+  }
+  text = text.substr(0, text.find_last_not_of(' ') + 1);
+  if (getAdrIndex() != -1) {
+    text += " " + to_string(firstOrderAdr[0].val);
+  }
+  return text;
 }
 
 /*
  * Doesn't include empty instructions from last non-empty on.
  */
 vector<Instruction> Instruction::getEffectiveInstructions(const Ram &ram, 
-                                                     const vector<bool> &reg) {
+                                                         uint8_t reg) {
   vector<Instruction> allInstructions = Instruction::getAllInstructions(ram, 
                                                                         reg);
   int lastNonemptyInst = 
@@ -40,9 +55,9 @@ vector<Instruction> Instruction::getEffectiveInstructions(const Ram &ram,
 }
 
 vector<Instruction> Instruction::getAllInstructions(const Ram &ram, 
-                                                    const vector<bool> &reg) {
+                                                    uint8_t reg) {
   vector<Instruction> out;
-  for (vector<bool> word : ram.state.at(CODE)) {
+  for (uint8_t word : ram.state[CODE]) {
     Instruction inst = Instruction(word, EMPTY_WORD, &ram);
     out.push_back(inst);
   }
@@ -66,88 +81,3 @@ vector<Instruction> Instruction::removeElementsPastIndex(
     vector<Instruction> &iii, int index) {
   return vector<Instruction>(iii.begin(), iii.begin() + index);
 }
-
-///////////////
-/// PRIVATE ///
-///////////////
-
-vector<Address> Instruction::getFirstOrderAdr(vector<bool> val) {
-  return inst->getFirstOrderAdr(val);
-}
-
-Address Instruction::getAddress(Address firstOrderAdr, const vector<bool> &reg,
-                                const Ram *ram) {
-  return inst->getAddress(firstOrderAdr, reg, ram);
-}
-
-SpecificInstruction * Instruction::getInstruction() {
-  switch (index) {
-    case 0:
-      return new Read;
-    case 1:
-      return new Write;
-    case 2:
-      return new Add;
-    case 3:
-      return new Sub;
-    case 4:
-      return new Jump;
-    case 5:
-      return new IfMax;
-    case 6:
-      return new IfMin;
-    case 7:
-      return getLogicInstruction();
-    case 8:
-      return new ReadPointer;
-    case 9:
-      return new WritePointer;
-    case 10: {
-      if (val[4] == false) {
-        return new Increase;
-      } else {
-        return new Decrease;
-      }
-    }
-    case 11:
-      return new Print;
-    case 13:
-      return new IfNotMax;
-    case 14:
-      return new IfNotMin;
-    default:
-      return new Read;
-  }
-}
-
-SpecificInstruction * Instruction::getLogicInstruction() {
-  switch (logicIndex) {
-    case 0:
-      return new JumpReg;
-    case 1:
-      return new ReadReg;
-    case 2:
-      return new InitializeFirstAddress;
-    case 3:
-      return new Not;
-    case 4:
-      return new ShiftLeft;
-    case 5:
-      return new ShiftRight;
-    case 6:
-      return new And;
-    case 7:
-      return new Or;
-    case 8:
-    case 9:
-    case 10:
-    case 11:
-    case 12:
-    case 13:
-    case 14:
-    case 15: 
-      return new Xor;
-    default:
-      return new Read;
-  }
-}
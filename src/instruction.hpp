@@ -1,11 +1,13 @@
 #ifndef INSTRUCTION_H
 #define INSTRUCTION_H
 
+#include <array>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
 #include "address.hpp"
-#include "specific_instruction.hpp"
+#include "isa.hpp"
 #include "util.hpp"
 
 using namespace std;
@@ -18,46 +20,41 @@ class Instruction {
      * Ram can also be NULL. In this case the pointer instructions that need
      * ram to define address, will asume the ram is empty.
      */
-    Instruction(vector<bool> valIn, const vector<bool> &regIn, const Ram *ramIn)
+    Instruction(uint8_t valIn, uint8_t regIn, const Ram *ramIn)
         : val(valIn),
-          index(Util::getInt(Util::getFirstNibble(valIn))),
-          logicIndex(Util::getInt(Util::getSecondNibble(valIn))),
-          inst(getInstruction()),
-          firstOrderAdr(getFirstOrderAdr(valIn)),
-          adr(getAddress(firstOrderAdr[0], regIn, ramIn)),
-          label(inst->getLabel()) { }
+          index(valIn >> 4),
+          logicIndex(valIn & 0x0f),
+          opcode(Isa::decode(valIn)),
+          firstOrderAdr({{ Isa::getFirstOrderAdr(opcode, valIn),
+                           Isa::getSecondFirstOrderAdr(opcode, valIn) }}),
+          adr(Isa::getAddress(opcode, firstOrderAdr[0], regIn, ramIn)),
+          label(Isa::get(opcode).label) { }
 
     bool operator == (const Instruction &other) const {
       return val == other.val;
     }
 
-    const vector<bool> val;
+    const uint8_t val;
     const int index;
     const int logicIndex;
-    SpecificInstruction * const inst;
-    const vector<Address> firstOrderAdr;
+    const Opcode opcode;
+    // Addresses referenced by the instruction word. Only INIT references
+    // two different addresses, for others both elements are the same.
+    const array<Address, 2> firstOrderAdr;
     const Address adr;
-    const string label;
+    const char * const label;
 
-    void exec(vector<bool> &pc, vector<bool> &reg, Ram &ram);
     bool isLogic();
-    string getCode(int pc);
+    int getAdrIndex();
+    string getText();
     
-    static vector<Instruction> getEffectiveInstructions(
-        const Ram &ram, const vector<bool> &reg);
-    static vector<Instruction> getAllInstructions(const Ram &ram, 
-                                                  const vector<bool> &reg);
+    static vector<Instruction> getEffectiveInstructions(const Ram &ram,
+                                                        uint8_t reg);
+    static vector<Instruction> getAllInstructions(const Ram &ram, uint8_t reg);
     static int getIndexOfLastNonEmptyInst(
         const vector<Instruction> &allInstructions);
     static vector<Instruction> removeElementsPastIndex(vector<Instruction> &iii,
                                                        int index);
-
-  private:
-    vector<Address> getFirstOrderAdr(vector<bool> val);
-    Address getAddress(Address firstOrderAdr, const vector<bool> &reg,
-                       const Ram *ram);
-    SpecificInstruction * getInstruction();
-    SpecificInstruction * getLogicInstruction();
 };
 
 #endif
\ No newline at end of file
@@ -30,6 +30,7 @@ extern "C" {
 
 // MAIN
 void startInteractiveMode(string filename);
+void createViews();
 void selectView();
 void prepareOutput();
 void updateBuffer();
@@ -60,10 +61,12 @@ char readStdin();
 //////// VARS ////////
 //////////////////////
 
-View view3d = View(drawing3D, LIGHTBULB_ON_3D, LIGHTBULB_OFF_3D);
-View view3db = View(drawing3Db, LIGHTBULB_ON_3D_B, LIGHTBULB_OFF_3D_B);
-View view2d = View(drawing2D, LIGHTBULB_ON_2D, LIGHTBULB_OFF_2D);
-View *selectedView = &view3d;
+// Views get created when interactive mode starts, so other modes don't
+// need to split the drawings into lines.
+View *view3d = NULL;
+View *view3db = NULL;
+View *view2d = NULL;
+View *selectedView = NULL;
 RandomInput input;
 Computer computer = Computer(redrawScreen, sleepAndCheckForKey);
 Printer printer = Printer(computer, redrawScreen, sleepAndCheckForKey);
@@ -77,7 +80,7 @@ bool fileSaved = true;
 // Number of executions.
 int executionCounter = 0;
 // Saved state of a ram. Loaded after execution ends.
-map<AddrSpace, vector<vector<bool>>> savedRamState;
+RamState savedRamState;
 // Whether next key should be read as a char whose value shall thence be
 // inserted into ram.
 bool insertChar = false;
@@ -85,7 +88,7 @@ bool insertNumber = false;
 vector<int> digits;
 bool shiftPressed = false;
 // Copy/paste.
-vector<bool> clipboard = EMPTY_WORD;
+vector<bool> clipboard = vector<bool>(WORD_SIZE);
 
 //////////////////////
 //////// MAIN ////////
@@ -98,6 +101,7 @@ void InteractiveMode::startInteractiveMode(string filename) {
     Load::fillRamWithFile(filename.c_str(), computer.ram);
     loadedFilename = filename;
   }
+  createViews();
   selectView();
   setEnvironment();
   prepareOutput();
@@ -106,12 +110,22 @@ void InteractiveMode::startInteractiveMode(string filename) {
   userInput();
 }
 
+void createViews() {
+  view3d = new View(vector<string>(begin(drawing3D), end(drawing3D)),
+                    LIGHTBULB_ON_3D, LIGHTBULB_OFF_3D);
+  view3db = new View(vector<string>(begin(drawing3Db), end(drawing3Db)),
+                     LIGHTBULB_ON_3D_B, LIGHTBULB_OFF_3D_B);
+  view2d = new View(vector<string>(begin(drawing2D), end(drawing2D)),
+                    LIGHTBULB_ON_2D, LIGHTBULB_OFF_2D);
+  selectedView = view3d;
+}
+
 void selectView() {
   const char* term = std::getenv("TERM");
   if (strcmp(term, "linux") == 0) {
-    selectedView = &view2d;
+    selectedView = view2d;
   } else if (strcmp(term, "rxvt") == 0) {
-    selectedView = &view2d;
+    selectedView = view2d;
   }
 }
 
@@ -506,18 +520,18 @@ void engageInsertNumberMode() {
 
 void switchDrawing(bool direction) {
   if (direction) {
-    if (*selectedView == view3d) {
-      selectedView = &view3db;
-    } else if (*selectedView == view3db) {
-      selectedView = &view2d;
+    if (selectedView == view3d) {
+      selectedView = view3db;
+    } else if (selectedView == view3db) {
+      selectedView = view2d;
     } else {
       return;
     }
   } else {
-    if (*selectedView == view3db) {
-      selectedView = &view3d;
-    } else if (*selectedView == view2d) {
-      selectedView = &view3db;
+    if (selectedView == view3db) {
+      selectedView = view3d;
+    } else if (selectedView == view2d) {
+      selectedView = view3db;
     } else {
       return;
     }
@@ -0,0 +1,423 @@
+#include "isa.hpp"
+
+#include <algorithm>
+
+#include "address.hpp"
+#include "const.hpp"
+#include "ram.hpp"
+
+using namespace std;
+
+// EXEC FUNCTIONS
+static void execRead(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execWrite(const Address &adr, uint8_t &pc, uint8_t &reg,
+                      Ram &ram);
+static void execAdd(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execSub(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execJump(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execIfMax(const Address &adr, uint8_t &pc, uint8_t &reg,
+                      Ram &ram);
+static void execIfMin(const Address &adr, uint8_t &pc, uint8_t &reg,
+                      Ram &ram);
+static void execInit(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execNot(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execShiftLeft(const Address &adr, uint8_t &pc, uint8_t &reg,
+                          Ram &ram);
+static void execShiftRight(const Address &adr, uint8_t &pc, uint8_t &reg,
+                           Ram &ram);
+static void execAnd(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execOr(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execXor(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execInc(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execDec(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram);
+static void execPrint(const Address &adr, uint8_t &pc, uint8_t &reg,
+                      Ram &ram);
+static void execIfNotMax(const Address &adr, uint8_t &pc, uint8_t &reg,
+                         Ram &ram);
+static void execIfNotMin(const Address &adr, uint8_t &pc, uint8_t &reg,
+                         Ram &ram);
+
+// UTIL FUNCTIONS
+static void increasePc(uint8_t &pc);
+
+/*
+ * The whole instruction set. Entries have to be in the same order as the
+ * opcodes.
+ */
+static constexpr IsaEntry ISA_TABLE[NUM_OF_OPCODES] = {
+  { READ, "READ  ", DATA_OPERAND, 0, 0,
+    "reg = $OP;", NULL, execRead, READS_ADR },
+  { WRITE, "WRITE  ", DATA_OPERAND, 0, 0,
+    "data[$ADR] = reg;", "pc = $PC; return reg;", execWrite, WRITES_ADR },
+  { ADD, "ADD", DATA_OPERAND, 0, 0,
+    "reg = sadd(reg, $OP);", NULL, execAdd, READS_ADR },
+  { SUB, "SUB", DATA_OPERAND, 0, 0,
+    "reg = ssub(reg, $OP);", NULL, execSub, READS_ADR },
+  { JUMP, "JUMP", CODE_OPERAND, 0, 0,
+    "goto *a[$ADR];", NULL, execJump, NO_ACCESS },
+  { IF_MAX, "IF MAX", CODE_OPERAND, 0, 0,
+    "if (reg == $MAX) goto *a[$ADR];", NULL, execIfMax, NO_ACCESS },
+  { IF_MIN, "IF MIN", CODE_OPERAND, 0, 0,
+    "if (reg == 0) goto *a[$ADR];", NULL, execIfMin, NO_ACCESS },
+  { JUMP_REG, "JRI~<>&VX", REG_CODE_OPERAND, 0, 0,
+    "goto *a[reg&$SIZE];", NULL, execJump, NO_ACCESS },
+  { READ_REG, "JRI~<>&VX", REG_DATA_OPERAND, 0, 0,
+    "reg = data[reg&$SIZE];", NULL, execRead, READS_ADR },
+  { INIT, "JRI~<>&VX", FIXED_DATA_OPERAND, FIRST_ADDRESS, INIT_OPERAND_INDEX,
+    "data[$ADR] = data[$ADR2]; reg = data[$ADR];", NULL, execInit,
+    COPIES_TO_ADR },
+  { NOT, "JRI~<>&VX", NO_OPERAND, 0, 0,
+    "reg = ~reg;", NULL, execNot, NO_ACCESS },
+  { SHIFT_L, "JRI~<>&VX", NO_OPERAND, 0, 0,
+    "reg <<= 1;", NULL, execShiftLeft, NO_ACCESS },
+  { SHIFT_R, "JRI~<>&VX", NO_OPERAND, 0, 0,
+    "reg >>= 1;", NULL, execShiftRight, NO_ACCESS },
+  { AND, "JRI~<>&VX", FIXED_DATA_OPERAND, AND_OPERAND_INDEX,
+    AND_OPERAND_INDEX, "reg &= data[$ADR];", NULL, execAnd, READS_ADR },
+  { OR, "JRI~<>&VX", FIXED_DATA_OPERAND, OR_OPERAND_INDEX, OR_OPERAND_INDEX,
+    "reg |= data[$ADR];", NULL, execOr, READS_ADR },
+  { XOR, "JRI~<>&VX", SHORT_DATA_OPERAND, 0, 0,
+    "reg ^= $OP;", NULL, execXor, READS_ADR },
+  { READ_POINTER, "READ *", POINTER_OPERAND, 0, 0,
+    "adr = $OP&$SIZE; if (adr == $SIZE) reg = predecesor(); "
+    "else reg = data[adr];", NULL, execRead, READS_ADR },
+  { WRITE_POINTER, "WRITE *", POINTER_OPERAND, 0, 0,
+    "pc = $PC; adr = $OP&$SIZE; if (adr == $SIZE) return reg; "
+    "else data[adr] = reg;", NULL, execWrite, WRITES_ADR },
+  { INC, "INC/DEC", SHORT_DATA_OPERAND, 0, 0,
+    "data[$ADR]++; reg = data[$ADR];", NULL, execInc, UPDATES_ADR },
+  { DEC, "INC/DEC", SHORT_DATA_OPERAND, 0, 0,
+    "data[$ADR]--; reg = data[$ADR];", NULL, execDec, UPDATES_ADR },
+  { PRINT, "PRINT", DATA_OPERAND, 0, 0,
+    "pc = $PC; return $OP;", NULL, execPrint, PRINTS_ADR },
+  { IF_NOT_MAX, "IF NOT MAX", CODE_OPERAND, 0, 0,
+    "if (reg != $MAX) goto *a[$ADR];", NULL, execIfNotMax, NO_ACCESS },
+  { IF_NOT_MIN, "IF NOT MIN", CODE_OPERAND, 0, 0,
+    "if (reg != 0) goto *a[$ADR];", NULL, execIfNotMin, NO_ACCESS }
+};
+
+static constexpr bool tableInOrder(int i) {
+  return i == NUM_OF_OPCODES ||
+         (ISA_TABLE[i].opcode == i && tableInOrder(i + 1));
+}
+
+static_assert(tableInOrder(0), "ISA table is not in the order of opcodes.");
+
+/////////////////
+/// INTERFACE ///
+/////////////////
+
+Opcode Isa::decode(uint8_t val) {
+  switch (val >> 4) {
+    case 0:
+      return READ;
+    case 1:
+      return WRITE;
+    case 2:
+      return ADD;
+    case 3:
+      return SUB;
+    case 4:
+      return JUMP;
+    case 5:
+      return IF_MAX;
+    case 6:
+      return IF_MIN;
+    case 7: {
+      static const Opcode LOGIC_OPS[] = { JUMP_REG, READ_REG, INIT, NOT,
+                                          SHIFT_L, SHIFT_R, AND, OR };
+      int logicIndex = val & 0x0f;
+      return logicIndex < 8 ? LOGIC_OPS[logicIndex] : XOR;
+    }
+    case 8:
+      return READ_POINTER;
+    case 9:
+      return WRITE_POINTER;
+    case 10:
+      return (val & 0x08) == 0 ? INC : DEC;
+    case 11:
+      return PRINT;
+    case 13:
+      return IF_NOT_MAX;
+    case 14:
+      return IF_NOT_MIN;
+    default:
+      return READ;
+  }
+}
+
+const IsaEntry& Isa::get(Opcode opcode) {
+  return ISA_TABLE[opcode];
+}
+
+/*
+ * Returns address that is specified by the instruction word itself.
+ */
+Address Isa::getFirstOrderAdr(Opcode opcode, uint8_t val) {
+  const IsaEntry &entry = ISA_TABLE[opcode];
+  switch (entry.operandKind) {
+    case DATA_OPERAND:
+    case POINTER_OPERAND:
+      return Address(DATA, val & 0x0f);
+    case CODE_OPERAND:
+      return Address(CODE, val & 0x0f);
+    case SHORT_DATA_OPERAND:
+      return Address(DATA, val & 0x07);
+    case FIXED_DATA_OPERAND:
+      return Address(DATA, entry.fixedAdr);
+    default:
+      return Address(NONE, FIRST_ADDRESS);
+  }
+}
+
+/*
+ * Only INIT references two addresses. For other instructions this is the
+ * same as first order address.
+ */
+Address Isa::getSecondFirstOrderAdr(Opcode opcode, uint8_t val) {
+  const IsaEntry &entry = ISA_TABLE[opcode];
+  if (entry.operandKind == FIXED_DATA_OPERAND) {
+    return Address(DATA, entry.secondFixedAdr);
+  }
+  return getFirstOrderAdr(opcode, val);
+}
+
+/*
+ * Returns the address that instruction will use when executed. Ram can also
+ * be NULL, in which case pointers are treated as if the ram was empty.
+ * Reading a pointer from the IN/OUT address consumes input.
+ */
+Address Isa::getAddress(Opcode opcode, const Address &firstOrderAdr,
+                        uint8_t reg, const Ram *ram) {
+  switch (ISA_TABLE[opcode].operandKind) {
+    case REG_DATA_OPERAND:
+      return Address(DATA, reg & 0x0f);
+    case REG_CODE_OPERAND:
+      return Address(CODE, reg & 0x0f);
+    case POINTER_OPERAND: {
+      if (ram == NULL) {
+        return Address(DATA, FIRST_ADDRESS);
+      }
+      uint8_t pointer = ram->get(firstOrderAdr);
+      return Address(DATA, pointer & 0x0f);
+    }
+    default:
+      return firstOrderAdr;
+  }
+}
+
+/*
+ * Index of the first bit of the address within the instruction word, or -1
+ * if address is not part of the word.
+ */
+int Isa::getAdrIndex(Opcode opcode) {
+  switch (ISA_TABLE[opcode].operandKind) {
+    case DATA_OPERAND:
+    case CODE_OPERAND:
+    case POINTER_OPERAND:
+      return 4;
+    case SHORT_DATA_OPERAND:
+      return 5;
+    default:
+      return -1;
+  }
+}
+
+/*
+ * Whether instruction can jump. Every infinite loop has to execute at least
+ * one of these.
+ */
+bool Isa::isJump(Opcode opcode) {
+  OperandKind kind = ISA_TABLE[opcode].operandKind;
+  return kind == CODE_OPERAND || kind == REG_CODE_OPERAND;
+}
+
+//////////////////////
+/// EXEC FUNCTIONS ///
+//////////////////////
+
+/*
+ * Copies value at the passed address to the register.
+ */
+void execRead(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg = ram.get(adr);
+  increasePc(pc);
+}
+
+/*
+ * Copies value of the register to the passed address.
+ */
+void execWrite(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  ram.set(adr, reg);
+  increasePc(pc);
+}
+
+/*
+ * Adds value at the passed address to the register. Result is saturated.
+ */
+void execAdd(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg = min(reg + ram.get(adr), MAX_VALUE);
+  increasePc(pc);
+}
+
+/*
+ * Subtracts value at the passed address from the register. Result is
+ * saturated.
+ */
+void execSub(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg = max(reg - ram.get(adr), 0);
+  increasePc(pc);
+}
+
+/*
+ * Jumps to the passed address.
+ */
+void execJump(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  pc = adr.val;
+}
+
+/*
+ * Jumps to passed address if value of the register is 'max'.
+ */
+void execIfMax(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  if (reg >= MAX_VALUE) {
+    pc = adr.val;
+  } else {
+    increasePc(pc);
+  }
+}
+
+/*
+ * Jumps to passed address if value of the register is 'min'.
+ */
+void execIfMin(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  if (reg == 0) {
+    pc = adr.val;
+  } else {
+    increasePc(pc);
+  }
+}
+
+/*
+ * Copies value at the second address to the first address and register.
+ */
+void execInit(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  uint8_t value = ram.get(Address(DATA, ISA_TABLE[INIT].secondFixedAdr));
+  ram.set(adr, value);
+  reg = value;
+  increasePc(pc);
+}
+
+/*
+ * Executes 'not' operation on the value of the register.
+ */
+void execNot(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg = ~reg;
+  increasePc(pc);
+}
+
+/*
+ * Shifts bits in the register one spot to the left.
+ */
+void execShiftLeft(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg <<= 1;
+  increasePc(pc);
+}
+
+/*
+ * Shifts bits in the register one spot to the right.
+ */
+void execShiftRight(const Address &adr, uint8_t &pc, uint8_t &reg,
+                    Ram &ram) {
+  reg >>= 1;
+  increasePc(pc);
+}
+
+/*
+ * Executes 'and' operation between register value, and value at the
+ * passed address and writes the result to register.
+ */
+void execAnd(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg &= ram.get(adr);
+  increasePc(pc);
+}
+
+/*
+ * Executes 'or' operation between register value, and value at the
+ * passed address and writes the result to register.
+ */
+void execOr(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg |= ram.get(adr);
+  increasePc(pc);
+}
+
+/*
+ * Executes 'xor' operation between register value, and value at the
+ * passed address (0-7) and writes the result to register.
+ */
+void execXor(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg ^= ram.get(adr);
+  increasePc(pc);
+}
+
+/*
+ * Increases value at the passed address, and copies it to the register.
+ * Value wraps around.
+ */
+void execInc(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg = ram.get(adr) + 1;
+  ram.set(adr, reg);
+  increasePc(pc);
+}
+
+/*
+ * Decreases value at the passed address, and copies it to the register.
+ * Value wraps around.
+ */
+void execDec(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  reg = ram.get(adr) - 1;
+  ram.set(adr, reg);
+  increasePc(pc);
+}
+
+/*
+ * Copies value at the passed address to the last address and thus
+ * sends it to the printer.
+ */
+void execPrint(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  uint8_t val = ram.get(adr);
+  ram.set(Address(DATA, LAST_ADDRESS), val);
+  increasePc(pc);
+}
+
+/*
+ * Jumps to passed address if value of the register is not 'max'.
+ */
+void execIfNotMax(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  if (reg >= MAX_VALUE) {
+    increasePc(pc);
+  } else {
+    pc = adr.val;
+  }
+}
+
+/*
+ * Jumps to passed address if value of the register is not 'min'.
+ */
+void execIfNotMin(const Address &adr, uint8_t &pc, uint8_t &reg, Ram &ram) {
+  if (reg == 0) {
+    increasePc(pc);
+  } else {
+    pc = adr.val;
+  }
+}
+
+//////////
+// UTIL //
+//////////
+
+void increasePc(uint8_t &pc) {
+  if (pc < LAST_ADDRESS) {
+    pc++;
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef ISA_H
+#define ISA_H
+
+#include <stdint.h>
+
+#include "address.hpp"
+
+using namespace std;
+
+class Ram;
+
+/*
+ * All instructions of the machine. Logic instructions (first nibble 7) and
+ * INC/DEC (first nibble 10) get one opcode per operation.
+ */
+enum Opcode { READ, WRITE, ADD, SUB, JUMP, IF_MAX, IF_MIN, JUMP_REG,
+              READ_REG, INIT, NOT, SHIFT_L, SHIFT_R, AND, OR, XOR,
+              READ_POINTER, WRITE_POINTER, INC, DEC, PRINT, IF_NOT_MAX,
+              IF_NOT_MIN, NUM_OF_OPCODES };
+
+/*
+ * How instruction gets its address from the instruction word.
+ */
+enum OperandKind {
+  NO_OPERAND,         // No address.
+  DATA_OPERAND,       // Last four bits point to data.
+  CODE_OPERAND,       // Last four bits point to code.
+  SHORT_DATA_OPERAND, // Last three bits point to data.
+  POINTER_OPERAND,    // Last four bits point to data, that holds address.
+  REG_DATA_OPERAND,   // Register holds the data address.
+  REG_CODE_OPERAND,   // Register holds the code address.
+  FIXED_DATA_OPERAND  // Always the same data address.
+};
+
+/*
+ * Which data words instruction reads and writes, besides the pointer that
+ * is read by POINTER_OPERAND. Used by profiler.
+ */
+enum DataAccess {
+  NO_ACCESS,
+  READS_ADR,      // Reads the word at the address.
+  WRITES_ADR,     // Writes to the address.
+  UPDATES_ADR,    // Reads the word at the address and writes it back.
+  COPIES_TO_ADR,  // Reads the second fixed address and writes to address.
+  PRINTS_ADR      // Reads the word at the address and writes it to IN/OUT.
+};
+
+typedef void (*ExecFunction)(const Address &adr, uint8_t &pc, uint8_t &reg,
+                             Ram &ram);
+
+/*
+ * Description of one instruction. Code templates are used when compiling
+ * a program to C and can contain following placeholders:
+ *   $ADR - value of the address,
+ *   $OP - value at the address, or 'predecesor()' for the IN/OUT address,
+ *   $PC - value of the program counter,
+ *   $MAX - max value of a word,
+ *   $SIZE - number of addresses.
+ */
+struct IsaEntry {
+  Opcode opcode;
+  const char *label;
+  OperandKind operandKind;
+  // Used by FIXED_DATA_OPERAND. Second one is the address that INIT reads.
+  uint8_t fixedAdr;
+  uint8_t secondFixedAdr;
+  const char *code;
+  // Used instead of 'code' if address is the IN/OUT address. Can be NULL.
+  const char *ioCode;
+  ExecFunction exec;
+  DataAccess access;
+};
+
+class Isa {
+  public:
+    static Opcode decode(uint8_t val);
+    static const IsaEntry& get(Opcode opcode);
+    static Address getFirstOrderAdr(Opcode opcode, uint8_t val);
+    static Address getSecondFirstOrderAdr(Opcode opcode, uint8_t val);
+    static Address getAddress(Opcode opcode, const Address &firstOrderAdr,
+                              uint8_t reg, const Ram *ram);
+    static int getAdrIndex(Opcode opcode);
+    static bool isJump(Opcode opcode);
+};
+
+#endif
@@ -0,0 +1,466 @@
+#include "jit_engine.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <type_traits>
+#include <vector>
+
+#include "address.hpp"
+#include "batch_mode.hpp"
+#include "const.hpp"
+#include "isa.hpp"
+#include "ram.hpp"
+
+using namespace std;
+
+static_assert(is_standard_layout<JitState>::value,
+              "JitState is accessed from generated code by offsets.");
+
+// Offsets of state fields.
+const uint8_t DATA_OFFSET = offsetof(JitState, data);
+const uint8_t PC_OFFSET = offsetof(JitState, pc);
+const uint8_t REG_OFFSET = offsetof(JitState, reg);
+const uint8_t BUDGET_OFFSET = offsetof(JitState, budget);
+
+// Labels that are not instructions. Instruction at last address is the
+// label where execution stops.
+const int EPILOGUE_LABEL = RAM_SIZE + 1;
+const int TABLE_LABEL = RAM_SIZE + 2;
+const int NUM_OF_LABELS = RAM_SIZE + 3;
+
+// Spot in the code, that has to be replaced with a 32 bit offset to a label,
+// relative to the end of the spot.
+struct Fixup {
+  size_t pos;
+  int label;
+};
+
+// CALLBACKS
+static uint32_t jitInput(JitState *state);
+static void jitOutput(JitState *state, uint32_t word);
+
+// CODE GENERATION
+static void generateInstruction(vector<uint8_t> &code, vector<Fixup> &fixups,
+                                uint8_t word, int pc);
+static void emit(vector<uint8_t> &code, vector<uint8_t> bytes);
+static void emit32(vector<uint8_t> &code, uint32_t val);
+static void emit64(vector<uint8_t> &code, uint64_t val);
+static void emitLabelRef(vector<uint8_t> &code, vector<Fixup> &fixups,
+                         int label);
+static size_t emitShortJump(vector<uint8_t> &code, uint8_t opcode);
+static void patchShortJump(vector<uint8_t> &code, size_t pos);
+static void emitLoad(vector<uint8_t> &code, uint8_t adr);
+static void emitDynamicLoad(vector<uint8_t> &code);
+static void emitInputCall(vector<uint8_t> &code);
+static void emitOutputAndExit(vector<uint8_t> &code, vector<Fixup> &fixups,
+                              vector<uint8_t> movToEsi, int pc);
+static void emitExit(vector<uint8_t> &code, vector<Fixup> &fixups,
+                     uint8_t pc, uint32_t returnValue);
+static void emitBudgetCheck(vector<uint8_t> &code, vector<Fixup> &fixups,
+                            int pc);
+static void emitTableJump(vector<uint8_t> &code, vector<Fixup> &fixups);
+static void emitSaturate(vector<uint8_t> &code);
+
+/////////////////
+/// INTERFACE ///
+/////////////////
+
+JitEngine::~JitEngine() {
+  freeBuffer();
+}
+
+bool JitEngine::isAvailable() {
+#if defined(__x86_64__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*
+ * Generates machine code for the program and copies it into executable
+ * memory. Needs to be called whenever the code changes.
+ */
+void JitEngine::load(const Ram &ram) {
+  freeBuffer();
+  // Failure ends the job with a jump, so it happens only after the vectors
+  // of 'writeCode()' were freed.
+  if (!writeCode(ram)) {
+    freeBuffer();
+    fprintf(stderr, "Error in function JitEngine::load, "
+            "could not create executable memory for the code.\n");
+    BatchMode::failJob(6);
+    exit(6);
+  }
+}
+
+/*
+ * Runs the program until it sends a word to the output, reaches the last
+ * address, or is about to execute more jumps than the budget allows.
+ * Behaves the same as calling Cpu::step in a loop.
+ */
+RunResult JitEngine::run(uint8_t &pc, uint8_t &reg, Ram &ram, long budget) {
+  if (function == NULL) {
+    load(ram);
+  }
+  uint32_t budget32 = min(budget, (long) UINT32_MAX);
+  JitState state = { ram.state[DATA].data(), &ram, pc, reg, budget32 };
+  RunResult result = function(&state);
+  pc = state.pc;
+  reg = state.reg;
+  return result;
+}
+
+///////////////
+/// PRIVATE ///
+///////////////
+
+/*
+ * Returns false if executable memory couldn't be allocated.
+ */
+bool JitEngine::writeCode(const Ram &ram) {
+  vector<size_t> labels;
+  size_t tableOffset;
+  vector<uint8_t> code = generateCode(ram, labels, tableOffset);
+  size_t pageSize = 4096;
+  bufferSize = (code.size() + pageSize - 1) / pageSize * pageSize;
+  void *mem = mmap(NULL, bufferSize, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANON, -1, 0);
+  if (mem == MAP_FAILED) {
+    return false;
+  }
+  buffer = (uint8_t*) mem;
+  memcpy(buffer, code.data(), code.size());
+  // Jump table holds absolute addresses of instructions.
+  for (int i = 0; i <= RAM_SIZE; i++) {
+    uint64_t address = (uint64_t) (buffer + labels[i]);
+    memcpy(buffer + tableOffset + i*sizeof(uint64_t), &address,
+           sizeof(uint64_t));
+  }
+  if (mprotect(buffer, bufferSize, PROT_READ | PROT_EXEC) != 0) {
+    return false;
+  }
+  function = (JitFunction) buffer;
+  return true;
+}
+
+void JitEngine::freeBuffer() {
+  if (buffer != NULL) {
+    munmap(buffer, bufferSize);
+  }
+  buffer = NULL;
+  bufferSize = 0;
+  function = NULL;
+}
+
+/*
+ * Generated function takes pointer to JitState and returns RunResult. It keeps
+ * pointer to state in r12, pointer to data in rbx and register in r13d.
+ * Labels get the offsets of instructions, last one being where execution
+ * stops.
+ */
+vector<uint8_t> JitEngine::generateCode(const Ram &ram,
+                                        vector<size_t> &labels,
+                                        size_t &tableOffset) {
+  vector<uint8_t> code;
+  vector<Fixup> fixups;
+  labels = vector<size_t>(NUM_OF_LABELS);
+  // push rbx; push r12; push r13; mov r12, rdi
+  emit(code, { 0x53, 0x41, 0x54, 0x41, 0x55, 0x49, 0x89, 0xfc });
+  // mov rbx, [r12+data]
+  emit(code, { 0x49, 0x8b, 0x5c, 0x24, DATA_OFFSET });
+  // movzx r13d, byte [r12+reg]
+  emit(code, { 0x45, 0x0f, 0xb6, 0x6c, 0x24, REG_OFFSET });
+  // movzx eax, byte [r12+pc]
+  emit(code, { 0x41, 0x0f, 0xb6, 0x44, 0x24, PC_OFFSET });
+  emitTableJump(code, fixups);
+  for (int i = 0; i < RAM_SIZE; i++) {
+    labels[i] = code.size();
+    generateInstruction(code, fixups, ram.state[CODE][i], i);
+  }
+  labels[RAM_SIZE] = code.size();
+  emitExit(code, fixups, RAM_SIZE, RUN_STOPPED);
+  labels[EPILOGUE_LABEL] = code.size();
+  // mov [r12+reg], r13b; pop r13; pop r12; pop rbx; ret
+  emit(code, { 0x45, 0x88, 0x6c, 0x24, REG_OFFSET,
+               0x41, 0x5d, 0x41, 0x5c, 0x5b, 0xc3 });
+  while (code.size() % sizeof(uint64_t) != 0) {
+    code.push_back(0xcc);
+  }
+  tableOffset = code.size();
+  labels[TABLE_LABEL] = tableOffset;
+  code.resize(tableOffset + (RAM_SIZE+1) * sizeof(uint64_t), 0);
+  for (Fixup fixup : fixups) {
+    int32_t rel = labels[fixup.label] - (fixup.pos + 4);
+    memcpy(code.data() + fixup.pos, &rel, sizeof(int32_t));
+  }
+  return code;
+}
+
+/////////////////
+/// CALLBACKS ///
+/////////////////
+
+uint32_t jitInput(JitState *state) {
+  return state->ram->get(Address(DATA, LAST_ADDRESS));
+}
+
+void jitOutput(JitState *state, uint32_t word) {
+  state->ram->set(Address(DATA, LAST_ADDRESS), word);
+}
+
+///////////////////////
+/// CODE GENERATION ///
+///////////////////////
+
+/*
+ * Code of every instruction falls through to the next one.
+ */
+void generateInstruction(vector<uint8_t> &code, vector<Fixup> &fixups,
+                         uint8_t word, int pc) {
+  Opcode opcode = Isa::decode(word);
+  const IsaEntry &entry = Isa::get(opcode);
+  uint8_t adr = Isa::getFirstOrderAdr(opcode, word).val;
+  if (Isa::isJump(opcode)) {
+    emitBudgetCheck(code, fixups, pc);
+  }
+  switch (opcode) {
+    case READ:
+      emitLoad(code, adr);
+      emit(code, { 0x41, 0x89, 0xc5 });       // mov r13d, eax
+      break;
+    case WRITE:
+      if (adr == LAST_ADDRESS) {
+        // mov esi, r13d
+        emitOutputAndExit(code, fixups, { 0x44, 0x89, 0xee }, pc);
+      } else {
+        emit(code, { 0x44, 0x88, 0x6b, adr }); // mov [rbx+adr], r13b
+      }
+      break;
+    case ADD:
+      emitLoad(code, adr);
+      emit(code, { 0x41, 0x01, 0xc5 });       // add r13d, eax
+      emitSaturate(code);
+      break;
+    case SUB:
+      emitLoad(code, adr);
+      emit(code, { 0x31, 0xc9 });             // xor ecx, ecx
+      emit(code, { 0x41, 0x29, 0xc5 });       // sub r13d, eax
+      emit(code, { 0x44, 0x0f, 0x42, 0xe9 }); // cmovb r13d, ecx
+      break;
+    case JUMP:
+      emit(code, { 0xe9 });                   // jmp
+      emitLabelRef(code, fixups, adr);
+      break;
+    case IF_MAX:
+    case IF_NOT_MAX:
+      emit(code, { 0x41, 0x81, 0xfd });       // cmp r13d, MAX_VALUE
+      emit32(code, MAX_VALUE);
+      // je or jne
+      emit(code, { 0x0f, (uint8_t) (opcode == IF_MAX ? 0x84 : 0x85) });
+      emitLabelRef(code, fixups, adr);
+      break;
+    case IF_MIN:
+    case IF_NOT_MIN:
+      emit(code, { 0x45, 0x85, 0xed });       // test r13d, r13d
+      // je or jne
+      emit(code, { 0x0f, (uint8_t) (opcode == IF_MIN ? 0x84 : 0x85) });
+      emitLabelRef(code, fixups, adr);
+      break;
+    case JUMP_REG:
+      emit(code, { 0x44, 0x89, 0xe8 });       // mov eax, r13d
+      emit(code, { 0x83, 0xe0, 0x0f });       // and eax, 15
+      emitTableJump(code, fixups);
+      break;
+    case READ_REG:
+      emit(code, { 0x44, 0x89, 0xe8 });       // mov eax, r13d
+      emit(code, { 0x83, 0xe0, 0x0f });       // and eax, 15
+      emitDynamicLoad(code);
+      emit(code, { 0x41, 0x89, 0xc5 });       // mov r13d, eax
+      break;
+    case INIT:
+      emit(code, { 0x0f, 0xb6, 0x43, entry.secondFixedAdr }); // movzx eax
+      emit(code, { 0x88, 0x43, entry.fixedAdr }); // mov [rbx+adr], al
+      emit(code, { 0x41, 0x89, 0xc5 });       // mov r13d, eax
+      break;
+    case NOT:
+      emit(code, { 0x41, 0xf7, 0xd5 });       // not r13d
+      emit(code, { 0x41, 0x81, 0xe5 });       // and r13d, MAX_VALUE
+      emit32(code, MAX_VALUE);
+      break;
+    case SHIFT_L:
+      emit(code, { 0x41, 0xd1, 0xe5 });       // shl r13d, 1
+      emit(code, { 0x41, 0x81, 0xe5 });       // and r13d, MAX_VALUE
+      emit32(code, MAX_VALUE);
+      break;
+    case SHIFT_R:
+      emit(code, { 0x41, 0xd1, 0xed });       // shr r13d, 1
+      break;
+    case AND:
+    case OR:
+    case XOR: {
+      emit(code, { 0x0f, 0xb6, 0x43, adr });  // movzx eax, byte [rbx+adr]
+      // and, or or xor r13d, eax
+      uint8_t op = opcode == AND ? 0x21 : (opcode == OR ? 0x09 : 0x31);
+      emit(code, { 0x41, op, 0xc5 });
+      break;
+    }
+    case READ_POINTER:
+      emitLoad(code, adr);
+      emit(code, { 0x83, 0xe0, 0x0f });       // and eax, 15
+      emitDynamicLoad(code);
+      emit(code, { 0x41, 0x89, 0xc5 });       // mov r13d, eax
+      break;
+    case WRITE_POINTER: {
+      emitLoad(code, adr);
+      emit(code, { 0x83, 0xe0, 0x0f });       // and eax, 15
+      emit(code, { 0x83, 0xf8, 0x0f });       // cmp eax, 15
+      size_t jumpToStore = emitShortJump(code, 0x75); // jne
+      // mov esi, r13d
+      emitOutputAndExit(code, fixups, { 0x44, 0x89, 0xee }, pc);
+      patchShortJump(code, jumpToStore);
+      emit(code, { 0x44, 0x88, 0x2c, 0x03 }); // mov [rbx+rax], r13b
+      break;
+    }
+    case INC:
+    case DEC:
+      // inc or dec byte [rbx+adr]
+      emit(code, { 0xfe, (uint8_t) (opcode == INC ? 0x43 : 0x4b), adr });
+      emit(code, { 0x44, 0x0f, 0xb6, 0x6b, adr }); // movzx r13d
+      break;
+    case PRINT:
+      emitLoad(code, adr);
+      emitOutputAndExit(code, fixups, { 0x89, 0xc6 }, pc); // mov esi, eax
+      break;
+    default:
+      break;
+  }
+}
+
+void emit(vector<uint8_t> &code, vector<uint8_t> bytes) {
+  code.insert(code.end(), bytes.begin(), bytes.end());
+}
+
+void emit32(vector<uint8_t> &code, uint32_t val) {
+  for (int i = 0; i < 4; i++) {
+    code.push_back((val >> (i*8)) & 0xff);
+  }
+}
+
+void emit64(vector<uint8_t> &code, uint64_t val) {
+  for (int i = 0; i < 8; i++) {
+    code.push_back((val >> (i*8)) & 0xff);
+  }
+}
+
+/*
+ * Reserves 32 bits for the offset to the label.
+ */
+void emitLabelRef(vector<uint8_t> &code, vector<Fixup> &fixups, int label) {
+  fixups.push_back({ code.size(), label });
+  emit32(code, 0);
+}
+
+/*
+ * Emits a short jump and returns position of its offset, that has to be
+ * patched after the code it jumps over is emitted.
+ */
+size_t emitShortJump(vector<uint8_t> &code, uint8_t opcode) {
+  code.push_back(opcode);
+  code.push_back(0);
+  return code.size() - 1;
+}
+
+void patchShortJump(vector<uint8_t> &code, size_t pos) {
+  code[pos] = code.size() - (pos + 1);
+}
+
+/*
+ * Loads word at the address into eax. Reading from the last address
+ * consumes input.
+ */
+void emitLoad(vector<uint8_t> &code, uint8_t adr) {
+  if (adr == LAST_ADDRESS) {
+    emitInputCall(code);
+  } else {
+    emit(code, { 0x0f, 0xb6, 0x43, adr });    // movzx eax, byte [rbx+adr]
+  }
+}
+
+/*
+ * Loads word at the address that is in eax into eax.
+ */
+void emitDynamicLoad(vector<uint8_t> &code) {
+  emit(code, { 0x83, 0xf8, 0x0f });           // cmp eax, 15
+  size_t jumpToInput = emitShortJump(code, 0x74); // je
+  emit(code, { 0x0f, 0xb6, 0x04, 0x03 });     // movzx eax, byte [rbx+rax]
+  size_t jumpToEnd = emitShortJump(code, 0xeb); // jmp
+  patchShortJump(code, jumpToInput);
+  emitInputCall(code);
+  patchShortJump(code, jumpToEnd);
+}
+
+void emitInputCall(vector<uint8_t> &code) {
+  emit(code, { 0x4c, 0x89, 0xe7 });           // mov rdi, r12
+  emit(code, { 0x48, 0xb8 });                 // mov rax, jitInput
+  emit64(code, (uint64_t) jitInput);
+  emit(code, { 0xff, 0xd0 });                 // call rax
+}
+
+/*
+ * Sends the word to output and returns from generated function, so that
+ * execution continues at the next instruction on the next run.
+ */
+void emitOutputAndExit(vector<uint8_t> &code, vector<Fixup> &fixups,
+                       vector<uint8_t> movToEsi, int pc) {
+  emit(code, movToEsi);
+  emit(code, { 0x4c, 0x89, 0xe7 });           // mov rdi, r12
+  emit(code, { 0x48, 0xb8 });                 // mov rax, jitOutput
+  emit64(code, (uint64_t) jitOutput);
+  emit(code, { 0xff, 0xd0 });                 // call rax
+  emitExit(code, fixups, pc+1, RUN_OUTPUT);
+}
+
+/*
+ * Saves pc and jumps to the epilogue, that saves register and returns.
+ */
+void emitExit(vector<uint8_t> &code, vector<Fixup> &fixups, uint8_t pc,
+              uint32_t returnValue) {
+  emit(code, { 0x41, 0xc6, 0x44, 0x24, PC_OFFSET, pc }); // mov [r12+pc]
+  emit(code, { 0xb8 });                       // mov eax, returnValue
+  emit32(code, returnValue);
+  emit(code, { 0xe9 });                       // jmp epilogue
+  emitLabelRef(code, fixups, EPILOGUE_LABEL);
+}
+
+/*
+ * Returns from generated function before the jump gets executed, if there
+ * is no budget left.
+ */
+void emitBudgetCheck(vector<uint8_t> &code, vector<Fixup> &fixups, int pc) {
+  // sub dword [r12+budget], 1
+  emit(code, { 0x41, 0x83, 0x6c, 0x24, BUDGET_OFFSET, 0x01 });
+  size_t jumpOverExit = emitShortJump(code, 0x73); // jae
+  emitExit(code, fixups, pc, RUN_BUDGET_SPENT);
+  patchShortJump(code, jumpOverExit);
+}
+
+/*
+ * Jumps to the instruction whose address is in rax.
+ */
+void emitTableJump(vector<uint8_t> &code, vector<Fixup> &fixups) {
+  emit(code, { 0x48, 0x8d, 0x0d });           // lea rcx, [rip+table]
+  emitLabelRef(code, fixups, TABLE_LABEL);
+  emit(code, { 0xff, 0x24, 0xc1 });           // jmp [rcx+rax*8]
+}
+
+void emitSaturate(vector<uint8_t> &code) {
+  emit(code, { 0x41, 0x81, 0xfd });           // cmp r13d, MAX_VALUE
+  emit32(code, MAX_VALUE);
+  emit(code, { 0xb9 });                       // mov ecx, MAX_VALUE
+  emit32(code, MAX_VALUE);
+  emit(code, { 0x44, 0x0f, 0x47, 0xe9 });     // cmova r13d, ecx
+}
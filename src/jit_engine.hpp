@@ -0,0 +1,58 @@
+#ifndef JIT_ENGINE_H
+#define JIT_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "engine.hpp"
+
+using namespace std;
+
+class Ram;
+
+/*
+ * State that is shared between the generated code and the engine.
+ */
+struct JitState {
+  uint8_t *data;
+  Ram *ram;
+  uint8_t pc;
+  uint8_t reg;
+  // Number of jumps that can still be executed.
+  uint32_t budget;
+};
+
+/*
+ * Translates the program into x86-64 machine code. Register is kept in a
+ * host register and data words are accessed directly, while reading from
+ * or writing to the IN/OUT address calls back into the Ram. Only available
+ * on x86-64, 'isAvailable()' returns false elsewhere.
+ */
+class JitEngine {
+  public:
+    JitEngine() { }
+    // Copy doesn't share the code buffer, it gets generated again on run.
+    JitEngine(const JitEngine &other) { }
+    JitEngine& operator=(const JitEngine &other) = delete;
+    ~JitEngine();
+
+    static bool isAvailable();
+    void load(const Ram &ram);
+    RunResult run(uint8_t &pc, uint8_t &reg, Ram &ram, long budget);
+
+  private:
+    typedef RunResult (*JitFunction)(JitState *state);
+
+    uint8_t *buffer = NULL;
+    size_t bufferSize = 0;
+    JitFunction function = NULL;
+
+    bool writeCode(const Ram &ram);
+    void freeBuffer();
+    static vector<uint8_t> generateCode(const Ram &ram,
+                                        vector<size_t> &labels,
+                                        size_t &tableOffset);
+};
+
+#endif
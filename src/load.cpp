@@ -1,5 +1,7 @@
 #include "load.hpp"
 
+#include <sstream>
+
 #include "const.hpp"
 #include "ram.hpp"
 
@@ -11,16 +13,24 @@ void Load::fillRamWithFile(const char* filename, Ram &ram) {
   if (fileStream.fail()) {
     fprintf(stderr, "Invalid filename '%s'. Aborting ram load.", filename);
   } else {
-    fillRamWithFilestream(&fileStream, ram);
+    fillRamWithStream(&fileStream, ram);
     fileStream.close();  
   }
 }
 
-void Load::fillRamWithFilestream(ifstream* fileStream, Ram &ram) {
+/*
+ * Program is passed as the contents of a file.
+ */
+void Load::fillRamWithString(const string &program, Ram &ram) {
+  istringstream stream(program);
+  fillRamWithStream(&stream, ram);
+}
+
+void Load::fillRamWithStream(istream* stream, Ram &ram) {
   int address = 0;
-  while (!fileStream->eof()) {
+  while (!stream->eof()) {
     string line;
-    getline(*fileStream, line);
+    getline(*stream, line);
     bool lineEmptyOrAComment = line.empty() || line[0] == '#';
     if (lineEmptyOrAComment) {
       continue;
@@ -36,9 +46,9 @@ void Load::writeLineToRam(string line, int address, Ram &ram) {
   int bitIndex = 0;
   for (char c : line) {
     if (address < RAM_SIZE) { 
-      writeInstructionBitToRam(address, bitIndex, getBool(c), ram);
+      writeBitToRam(CODE, address, bitIndex, getBool(c), ram);
     } else {
-      writeDataBitToRam(address-RAM_SIZE, bitIndex, getBool(c), ram);
+      writeBitToRam(DATA, address-RAM_SIZE, bitIndex, getBool(c), ram);
     }
     if (++bitIndex >= WORD_SIZE) {
       return;
@@ -46,12 +56,14 @@ void Load::writeLineToRam(string line, int address, Ram &ram) {
   }
 }
 
-void Load::writeInstructionBitToRam(int address, int bitIndex, bool bitValue, Ram &ram) {
-  ram.state[CODE].at(address).at(bitIndex) = bitValue;
-}
-
-void Load::writeDataBitToRam(int address, int bitIndex, bool bitValue, Ram &ram) {
-  ram.state[DATA].at(address).at(bitIndex) = bitValue;
+void Load::writeBitToRam(AddrSpace space, int address, int bitIndex,
+                         bool bitValue, Ram &ram) {
+  uint8_t mask = 0x80 >> bitIndex;
+  if (bitValue) {
+    ram.state[space].at(address) |= mask;
+  } else {
+    ram.state[space].at(address) &= ~mask;
+  }
 }
 
 bool Load::getBool(char c) {
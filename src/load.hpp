@@ -2,8 +2,11 @@
 #define LOAD_H
 
 #include <fstream>
+#include <istream>
 #include <string>
 
+#include "addr_space.hpp"
+
 using namespace std;
 
 class Ram;
@@ -11,12 +14,13 @@ class Ram;
 class Load {
   public:
     static void fillRamWithFile(const char* filename, Ram &ram);
+    static void fillRamWithString(const string &program, Ram &ram);
 
   private:
-    static void fillRamWithFilestream(ifstream* fileStream, Ram &ram);
+    static void fillRamWithStream(istream* stream, Ram &ram);
     static void writeLineToRam(string line, int address, Ram &ram);
-    static void writeInstructionBitToRam(int address, int bitIndex, bool bitValue, Ram &ram);
-    static void writeDataBitToRam(int address, int bitIndex, bool bitValue, Ram &ram);
+    static void writeBitToRam(AddrSpace space, int address, int bitIndex,
+                              bool bitValue, Ram &ram);
     static bool getBool(char c);
 };
 
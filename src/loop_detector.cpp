@@ -0,0 +1,74 @@
+#include "loop_detector.hpp"
+
+#include <vector>
+
+#include "const.hpp"
+#include "provides_output.hpp"
+
+using namespace std;
+
+/*
+ * Returns 'true' if program returned to a state it was already in. Output
+ * is the word that program sent to output on the way to the passed state,
+ * or NO_OUTPUT.
+ */
+bool LoopDetector::check(const MachineState &state, bool inputRead,
+                         int outputWord) {
+  // Program can't be in a loop if it read from input.
+  if (inputRead || !checkpointSet) {
+    power = 1;
+    setCheckpoint(state);
+    return false;
+  }
+  if (outputWord != NO_OUTPUT) {
+    output.push_back(outputWord);
+  }
+  return advance(state);
+}
+
+/*
+ * Same as above, but for when program sent multiple words to output on the
+ * way to the passed state.
+ */
+bool LoopDetector::check(const MachineState &state, bool inputRead,
+                         const vector<uint8_t> &outputWords) {
+  if (inputRead || !checkpointSet) {
+    power = 1;
+    setCheckpoint(state);
+    return false;
+  }
+  output.insert(output.end(), outputWords.begin(), outputWords.end());
+  return advance(state);
+}
+
+/*
+ * Words that program sends to output during one run of the loop.
+ */
+const vector<uint8_t>& LoopDetector::getLoopOutput() const {
+  return output;
+}
+
+/*
+ * Compares the state with the checkpoint, and moves the checkpoint each
+ * time the number of checks since it was set reaches the next power of two.
+ */
+bool LoopDetector::advance(const MachineState &state) {
+  length++;
+  if (state == checkpoint) {
+    return true;
+  }
+  if (length == power) {
+    // Gives up on very long loops, so that the output doesn't grow
+    // without limit.
+    power = power < MAX_LOOP_CHECKS ? power * 2 : 1;
+    setCheckpoint(state);
+  }
+  return false;
+}
+
+void LoopDetector::setCheckpoint(const MachineState &state) {
+  checkpoint = state;
+  checkpointSet = true;
+  length = 0;
+  output.clear();
+}
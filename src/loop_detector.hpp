@@ -0,0 +1,37 @@
+#ifndef LOOP_DETECTOR_H
+#define LOOP_DETECTOR_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "machine_state.hpp"
+
+using namespace std;
+
+/*
+ * Detects when program repeats a state without reading input in between,
+ * meaning it will repeat the same steps forever. It is fed the states at
+ * which the engine stopped, that is after every output and after every
+ * LOOP_CHECK_JUMPS jumps. Uses Brent's algorithm, so only one state needs
+ * to be stored.
+ */
+class LoopDetector {
+  public:
+    bool check(const MachineState &state, bool inputRead, int outputWord);
+    bool check(const MachineState &state, bool inputRead,
+               const vector<uint8_t> &outputWords);
+    const vector<uint8_t>& getLoopOutput() const;
+
+  private:
+    bool checkpointSet = false;
+    MachineState checkpoint;
+    long power = 1;
+    long length = 0;
+    // Words sent to output since the checkpoint.
+    vector<uint8_t> output;
+
+    bool advance(const MachineState &state);
+    void setCheckpoint(const MachineState &state);
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef MACHINE_STATE_H
+#define MACHINE_STATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ram.hpp"
+
+using namespace std;
+
+/*
+ * Everything that program's future depends on, as long as it doesn't read
+ * from input.
+ */
+struct MachineState {
+  uint8_t pc;
+  uint8_t reg;
+  RamBank data;
+
+  bool operator == (const MachineState &other) const {
+    return pc == other.pc && reg == other.reg && data == other.data;
+  }
+};
+
+/*
+ * FNV-1a hash of the state, so it can be used as a key of unordered_map.
+ */
+struct MachineStateHash {
+  size_t operator () (const MachineState &state) const {
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ state.pc) * 16777619u;
+    hash = (hash ^ state.reg) * 16777619u;
+    for (uint8_t word : state.data) {
+      hash = (hash ^ word) * 16777619u;
+    }
+    return hash;
+  }
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "batch_mode.hpp"
+#include "const.hpp"
+
+using namespace std;
+
+static void failOnFile(const string &filename) {
+  cout << "Could not open file " << filename << "." << endl;
+  BatchMode::failJob(1);
+  exit(1);
+}
+
+MappedInputFile::MappedInputFile(const string &filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  struct stat s;
+  if (fd == -1 || fstat(fd, &s) == -1) {
+    failOnFile(filename);
+  }
+  size = s.st_size;
+  // Empty file can't be mapped.
+  if (size > 0) {
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      failOnFile(filename);
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = (const char *) mapping;
+  }
+  close(fd);
+}
+
+MappedInputFile::~MappedInputFile() {
+  if (data != NULL) {
+    munmap((void *) data, size);
+  }
+}
+
+MappedOutputFile::MappedOutputFile(const string &filename) {
+  fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    failOnFile(filename);
+  }
+}
+
+MappedOutputFile::~MappedOutputFile() {
+  truncate();
+  if (data != NULL) {
+    munmap(data, mappedSize);
+  }
+  close(fd);
+}
+
+void MappedOutputFile::write(const char *bytes, size_t count) {
+  if (size + count > mappedSize) {
+    grow(size + count);
+  }
+  memcpy(data + size, bytes, count);
+  size += count;
+}
+
+/*
+ * Cuts off the part of the file that was not written yet.
+ */
+void MappedOutputFile::truncate() {
+  if (ftruncate(fd, size) == -1) {
+    perror("Could not truncate output file");
+  }
+}
+
+///////////////
+/// PRIVATE ///
+///////////////
+
+void MappedOutputFile::grow(size_t minSize) {
+  size_t newSize = mappedSize;
+  while (newSize < minSize) {
+    newSize += MAPPED_OUTPUT_CHUNK;
+  }
+  if (data != NULL) {
+    munmap(data, mappedSize);
+  }
+  void *mapping = MAP_FAILED;
+  if (ftruncate(fd, newSize) == 0) {
+    mapping = mmap(NULL, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (mapping == MAP_FAILED) {
+    data = NULL;
+    mappedSize = 0;
+    perror("Could not extend output file");
+    BatchMode::failJob(1);
+    exit(1);
+  }
+  data = (char *) mapping;
+  mappedSize = newSize;
+}
\ No newline at end of file
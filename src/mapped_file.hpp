@@ -0,0 +1,47 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+/*
+ * Whole file mapped into memory for reading. Kernel is told that it will
+ * be read sequentially, so it reads ahead.
+ */
+class MappedInputFile {
+  public:
+    MappedInputFile(const string &filename);
+    ~MappedInputFile();
+    MappedInputFile(const MappedInputFile &other) = delete;
+    MappedInputFile& operator=(const MappedInputFile &other) = delete;
+
+    const char *data = NULL;
+    size_t size = 0;
+};
+
+/*
+ * File that gets written through a memory mapping. File is extended by
+ * MAPPED_OUTPUT_CHUNK bytes whenever it fills up, and cut to the size of
+ * the written data by 'truncate()'.
+ */
+class MappedOutputFile {
+  public:
+    MappedOutputFile(const string &filename);
+    ~MappedOutputFile();
+    MappedOutputFile(const MappedOutputFile &other) = delete;
+    MappedOutputFile& operator=(const MappedOutputFile &other) = delete;
+
+    void write(const char *bytes, size_t count);
+    void truncate();
+
+  private:
+    int fd = -1;
+    char *data = NULL;
+    size_t mappedSize = 0;
+    size_t size = 0;
+    void grow(size_t minSize);
+};
+
+#endif
\ No newline at end of file
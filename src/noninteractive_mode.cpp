@@ -1,14 +1,49 @@
 #include "noninteractive_mode.hpp"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string>
 #include <vector>
 
 #include "computer.hpp"
 #include "load.hpp"
+#include "parallel_chain.hpp"
 #include "ram.hpp"
 
 using namespace std;
 
+static NoninteractiveMode *runningMode = NULL;
+
+static void finishRunningMode() {
+  if (runningMode != NULL) {
+    runningMode->finish();
+  }
+}
+
 void NoninteractiveMode::run() {
-  output.run();
+  // Chain usually ends with exit(). Gets registered before the output, so
+  // that output gets flushed before the profiles are printed.
+  if (!profiles.empty() || trace) {
+    runningMode = this;
+    atexit(finishRunningMode);
+  }
+  if (parallel) {
+    ParallelChain::run(computerChain, input, output, fiberWorkers);
+  } else {
+    output.run();
+  }
+  finish();
+  runningMode = NULL;
+}
+
+void NoninteractiveMode::finish() {
+  if (trace) {
+    trace->finish();
+  }
+  for (size_t i = 0; i < profiles.size(); i++) {
+    const Computer &computer = computerChain[i];
+    string listing = profiles[i].getListing(computer.name,
+                                            computer.ram.state.at(CODE));
+    fputs(listing.c_str(), stderr);
+  }
 }
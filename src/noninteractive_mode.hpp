@@ -1,13 +1,18 @@
 #ifndef NONINTERACTIVE_MODE_H
 #define NONINTERACTIVE_MODE_H
 
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "computer.hpp"
+#include "engine.hpp"
 #include "load.hpp"
 #include "pipe_input.hpp"
+#include "profile.hpp"
 #include "standard_output.hpp"
+#include "trace.hpp"
 
 using namespace std;
 
@@ -16,14 +21,36 @@ class Ram;
 class NoninteractiveMode {
   public:
     NoninteractiveMode(vector<string> filenamesIn, bool outputNumbers, 
-                       bool outputChars, bool inputChars, bool rawInput) 
+                       bool outputChars, bool inputChars, bool rawInput,
+                       bool binary,
+                       Engine engine, bool memoize, bool parallelIn,
+                       size_t fiberWorkersIn, string inputFilename,
+                       string outputFilename, bool profile,
+                       string traceFilename) 
         : computerChain(vector<Computer>(filenamesIn.size())),
-          output(StandardOutput(outputNumbers, outputChars)),
-          input(PipeInput(inputChars, rawInput))
+          output(StandardOutput(outputNumbers, outputChars, rawInput)),
+          input(PipeInput(inputChars, rawInput, binary)),
+          parallel(parallelIn),
+          fiberWorkers(fiberWorkersIn)
     { 
       // Fills rams with contents of files.
       for (size_t i = 0; i < filenamesIn.size(); i++) {
         Load::fillRamWithFile(filenamesIn[i].c_str(), computerChain[i].ram);
+        computerChain[i].setEngine(engine);
+        computerChain[i].name = filenamesIn[i];
+        computerChain[i].memoize = memoize;
+      }
+      if (profile) {
+        profiles.resize(computerChain.size());
+        for (size_t i = 0; i < computerChain.size(); i++) {
+          computerChain[i].enableProfiling(&profiles[i]);
+        }
+      }
+      if (!traceFilename.empty()) {
+        trace = unique_ptr<Trace>(new Trace(traceFilename, filenamesIn));
+        for (size_t i = 0; i < computerChain.size(); i++) {
+          computerChain[i].enableTracing(trace->getBuffer(i));
+        }
       }
       // Connects input, computers and output into chain.
       computerChain[0].ram.input = &input;
@@ -31,14 +58,33 @@ class NoninteractiveMode {
         computerChain[i].ram.input = &computerChain[i-1];
       }
       output.input = &computerChain.back();
+      input.output = &output;
+      // Stdin and stdout get replaced with mapped files.
+      if (!inputFilename.empty()) {
+        input.readFromFile(inputFilename);
+      }
+      if (!outputFilename.empty()) {
+        output.writeToFile(outputFilename);
+      }
     }
 
     void run();
+    // Prints the profiles and closes the trace.
+    void finish();
 
   private:
     vector<Computer> computerChain;
     StandardOutput output;
     PipeInput input;
+    // Runs every computer on its own thread.
+    bool parallel;
+    // If not zero, computers of parallel chain run as fibers on this many
+    // threads.
+    size_t fiberWorkers;
+    // One for every computer, if running with '--profile'.
+    vector<Profile> profiles;
+    // Set if running with '--trace'.
+    unique_ptr<Trace> trace;
 };
 
 #endif
\ No newline at end of file
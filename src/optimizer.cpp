@@ -0,0 +1,444 @@
+#include "optimizer.hpp"
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "address.hpp"
+#include "const.hpp"
+#include "isa.hpp"
+#include "ram.hpp"
+
+using namespace std;
+
+// Register values during constant propagation. Known values are 0-255.
+const int UNKNOWN = -1;
+const int UNREACHED = -2;
+
+static OptimizedInstruction decode(uint8_t word);
+static OptimizedInstruction resolve(OptimizedInstruction inst, int reg,
+                                    const OptimizedProgram &prog,
+                                    const RamBank &data);
+static int getValue(const Address &adr, const OptimizedProgram &prog,
+                    const RamBank &data);
+static int getRegisterAfter(const OptimizedInstruction &inst, int reg,
+                            const OptimizedProgram &prog,
+                            const RamBank &data);
+static vector<int> getSuccessors(const OptimizedInstruction &inst, int index);
+static int join(int a, int b);
+static uint16_t getUses(const OptimizedInstruction &inst,
+                        const OptimizedProgram &prog);
+static uint16_t getDefs(const OptimizedInstruction &inst,
+                        const OptimizedProgram &prog);
+static uint16_t getBit(const Address &adr, const OptimizedProgram &prog);
+static bool hasSideEffects(const OptimizedInstruction &inst);
+
+/////////////////
+/// INTERFACE ///
+/////////////////
+
+OptimizedProgram Optimizer::optimize(const Ram &ram) {
+  OptimizedProgram prog;
+  prog.constant.fill(true);
+  // Every data word starts as a constant, and those that reachable code
+  // writes to get removed until none are left.
+  do {
+    propagateConstants(ram, prog);
+  } while (removeWrittenConstants(prog));
+  eliminateDeadStores(prog);
+  prog.dynamicData = false;
+  prog.dynamicJumps = false;
+  for (const OptimizedInstruction &inst : prog.code) {
+    if (!inst.reachable || inst.removed) {
+      continue;
+    }
+    Opcode op = inst.opcode;
+    if (op == READ_REG || op == READ_POINTER || op == WRITE_POINTER) {
+      prog.dynamicData = true;
+    } else if (op == JUMP_REG) {
+      prog.dynamicJumps = true;
+    }
+  }
+  return prog;
+}
+
+///////////////
+/// PRIVATE ///
+///////////////
+
+/*
+ * Finds reachable instructions and known values of the register, assuming
+ * that constant data words don't change. Instructions get resolved with
+ * the register value they can be executed with.
+ */
+void Optimizer::propagateConstants(const Ram &ram, OptimizedProgram &prog) {
+  const RamBank &data = ram.state[DATA];
+  array<OptimizedInstruction, RAM_SIZE> decoded;
+  for (int i = 0; i < RAM_SIZE; i++) {
+    decoded[i] = decode(ram.state[CODE][i]);
+  }
+  array<int, RAM_SIZE+1> regIn;
+  regIn.fill(UNREACHED);
+  regIn[0] = 0;
+  vector<int> unprocessed = { 0 };
+  while (!unprocessed.empty()) {
+    int i = unprocessed.back();
+    unprocessed.pop_back();
+    if (i == RAM_SIZE) {
+      continue;
+    }
+    prog.code[i] = resolve(decoded[i], regIn[i], prog, data);
+    int regOut = getRegisterAfter(prog.code[i], regIn[i], prog, data);
+    for (int next : getSuccessors(prog.code[i], i)) {
+      int joined = join(regIn[next], regOut);
+      if (joined != regIn[next]) {
+        regIn[next] = joined;
+        unprocessed.push_back(next);
+      }
+    }
+  }
+  for (int i = 0; i < RAM_SIZE; i++) {
+    if (regIn[i] == UNREACHED) {
+      prog.code[i] = decoded[i];
+    }
+    prog.code[i].reachable = regIn[i] != UNREACHED;
+  }
+}
+
+/*
+ * Returns 'true' if any of the constant data words gets written to.
+ */
+bool Optimizer::removeWrittenConstants(OptimizedProgram &prog) {
+  bool removed = false;
+  for (const OptimizedInstruction &inst : prog.code) {
+    if (!inst.reachable || inst.removed) {
+      continue;
+    }
+    Opcode op = inst.opcode;
+    bool writes = op == WRITE || op == INIT || op == INC || op == DEC;
+    for (int i = 0; i < RAM_SIZE; i++) {
+      bool written = op == WRITE_POINTER || (writes && inst.adr.val == i);
+      if (written && prog.constant[i]) {
+        prog.constant[i] = false;
+        removed = true;
+      }
+    }
+  }
+  return removed;
+}
+
+/*
+ * Removes instructions whose only effect is writing to variables, that get
+ * written again before they are read.
+ */
+void Optimizer::eliminateDeadStores(OptimizedProgram &prog) {
+  bool removed = true;
+  while (removed) {
+    removed = false;
+    computeLiveness(prog);
+    for (int i = 0; i < RAM_SIZE; i++) {
+      OptimizedInstruction &inst = prog.code[i];
+      if (!inst.reachable || inst.removed || hasSideEffects(inst)) {
+        continue;
+      }
+      uint16_t liveOut = 0;
+      for (int next : getSuccessors(inst, i)) {
+        liveOut |= prog.liveIn[next];
+      }
+      if ((getDefs(inst, prog) & liveOut) == 0) {
+        inst.removed = true;
+        removed = true;
+      }
+    }
+  }
+}
+
+void Optimizer::computeLiveness(OptimizedProgram &prog) {
+  prog.liveIn.fill(0);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int i = RAM_SIZE-1; i >= 0; i--) {
+      const OptimizedInstruction &inst = prog.code[i];
+      if (!inst.reachable) {
+        continue;
+      }
+      uint16_t liveOut = 0;
+      for (int next : getSuccessors(inst, i)) {
+        liveOut |= prog.liveIn[next];
+      }
+      uint16_t liveIn = getUses(inst, prog) |
+                        (liveOut & ~getDefs(inst, prog));
+      if (liveIn != prog.liveIn[i]) {
+        prog.liveIn[i] = liveIn;
+        changed = true;
+      }
+    }
+  }
+}
+
+//////////////
+/// STATIC ///
+//////////////
+
+static OptimizedInstruction decode(uint8_t word) {
+  Opcode opcode = Isa::decode(word);
+  return { opcode, Isa::getFirstOrderAdr(opcode, word),
+           Isa::getSecondFirstOrderAdr(opcode, word), false, false };
+}
+
+/*
+ * Replaces instructions whose address depends on the register or a
+ * pointer with the plain ones, when the address is known. Branches with
+ * known register become jumps, or get removed if they are never taken.
+ */
+static OptimizedInstruction resolve(OptimizedInstruction inst, int reg,
+                                    const OptimizedProgram &prog,
+                                    const RamBank &data) {
+  int pointer = getValue(inst.adr, prog, data);
+  switch (inst.opcode) {
+    case JUMP_REG:
+      if (reg != UNKNOWN) {
+        return { JUMP, Address(CODE, reg & 0x0f), inst.secondAdr, true,
+                 false };
+      }
+      break;
+    case READ_REG:
+      if (reg != UNKNOWN) {
+        return { READ, Address(DATA, reg & 0x0f), inst.secondAdr, true,
+                 false };
+      }
+      break;
+    case READ_POINTER:
+    case WRITE_POINTER:
+      if (pointer != UNKNOWN) {
+        Opcode opcode = inst.opcode == READ_POINTER ? READ : WRITE;
+        return { opcode, Address(DATA, pointer & 0x0f), inst.secondAdr, true,
+                 false };
+      }
+      break;
+    case IF_MAX:
+    case IF_MIN:
+    case IF_NOT_MAX:
+    case IF_NOT_MIN:
+      if (reg != UNKNOWN) {
+        bool taken = (inst.opcode == IF_MAX && reg == MAX_VALUE) ||
+                     (inst.opcode == IF_MIN && reg == 0) ||
+                     (inst.opcode == IF_NOT_MAX && reg != MAX_VALUE) ||
+                     (inst.opcode == IF_NOT_MIN && reg != 0);
+        if (taken) {
+          inst.opcode = JUMP;
+        } else {
+          inst.removed = true;
+        }
+      }
+      break;
+    default:
+      break;
+  }
+  inst.reachable = true;
+  return inst;
+}
+
+/*
+ * Returns value of the data word if it's a constant, else UNKNOWN.
+ */
+static int getValue(const Address &adr, const OptimizedProgram &prog,
+                    const RamBank &data) {
+  if (adr.val >= RAM_SIZE || !prog.constant[adr.val]) {
+    return UNKNOWN;
+  }
+  return data[adr.val];
+}
+
+static int getRegisterAfter(const OptimizedInstruction &inst, int reg,
+                            const OptimizedProgram &prog,
+                            const RamBank &data) {
+  if (inst.removed) {
+    return reg;
+  }
+  int value = getValue(inst.adr, prog, data);
+  bool known = reg != UNKNOWN && value != UNKNOWN;
+  switch (inst.opcode) {
+    case READ:
+      return value;
+    case ADD:
+      return known ? min(reg + value, MAX_VALUE) : UNKNOWN;
+    case SUB:
+      return known ? max(reg - value, 0) : UNKNOWN;
+    case AND:
+      return known ? reg & value : UNKNOWN;
+    case OR:
+      return known ? reg | value : UNKNOWN;
+    case XOR:
+      return known ? reg ^ value : UNKNOWN;
+    case NOT:
+      return reg != UNKNOWN ? (uint8_t) ~reg : UNKNOWN;
+    case SHIFT_L:
+      return reg != UNKNOWN ? (uint8_t) (reg << 1) : UNKNOWN;
+    case SHIFT_R:
+      return reg != UNKNOWN ? reg >> 1 : UNKNOWN;
+    case INIT:
+      return getValue(inst.secondAdr, prog, data);
+    case READ_REG:
+    case READ_POINTER:
+    case INC:
+    case DEC:
+      return UNKNOWN;
+    default:
+      return reg;
+  }
+}
+
+/*
+ * Addresses that execution can continue from. RAM_SIZE stands for the
+ * last address, where it stops.
+ */
+static vector<int> getSuccessors(const OptimizedInstruction &inst,
+                                 int index) {
+  if (inst.removed) {
+    return { index + 1 };
+  }
+  switch (inst.opcode) {
+    case JUMP:
+      return { inst.adr.val };
+    case IF_MAX:
+    case IF_MIN:
+    case IF_NOT_MAX:
+    case IF_NOT_MIN:
+      return { inst.adr.val, index + 1 };
+    case JUMP_REG: {
+      vector<int> all;
+      for (int i = 0; i <= RAM_SIZE; i++) {
+        all.push_back(i);
+      }
+      return all;
+    }
+    default:
+      return { index + 1 };
+  }
+}
+
+static int join(int a, int b) {
+  if (a == UNREACHED || a == b) {
+    return b;
+  }
+  if (b == UNREACHED) {
+    return a;
+  }
+  return UNKNOWN;
+}
+
+/*
+ * Variables that instruction reads. Constant data words are left out.
+ */
+static uint16_t getUses(const OptimizedInstruction &inst,
+                        const OptimizedProgram &prog) {
+  if (inst.removed) {
+    return 0;
+  }
+  uint16_t allData = 0;
+  for (int i = 0; i < RAM_SIZE; i++) {
+    allData |= getBit(Address(DATA, i), prog);
+  }
+  uint16_t adrBit = getBit(inst.adr, prog);
+  switch (inst.opcode) {
+    case READ:
+    case PRINT:
+    case INC:
+    case DEC:
+      return adrBit;
+    case WRITE:
+    case IF_MAX:
+    case IF_MIN:
+    case IF_NOT_MAX:
+    case IF_NOT_MIN:
+    case JUMP_REG:
+    case NOT:
+    case SHIFT_L:
+    case SHIFT_R:
+      return REG_BIT;
+    case ADD:
+    case SUB:
+    case AND:
+    case OR:
+    case XOR:
+    case WRITE_POINTER:
+      return REG_BIT | adrBit;
+    case READ_REG:
+      return REG_BIT | allData;
+    case READ_POINTER:
+      return adrBit | allData;
+    case INIT:
+      return getBit(inst.secondAdr, prog);
+    default:
+      return 0;
+  }
+}
+
+/*
+ * Variables that instruction always writes to.
+ */
+static uint16_t getDefs(const OptimizedInstruction &inst,
+                        const OptimizedProgram &prog) {
+  if (inst.removed) {
+    return 0;
+  }
+  switch (inst.opcode) {
+    case READ:
+    case ADD:
+    case SUB:
+    case AND:
+    case OR:
+    case XOR:
+    case NOT:
+    case SHIFT_L:
+    case SHIFT_R:
+    case READ_REG:
+    case READ_POINTER:
+      return REG_BIT;
+    case WRITE:
+      return getBit(inst.adr, prog);
+    case INIT:
+    case INC:
+    case DEC:
+      return REG_BIT | getBit(inst.adr, prog);
+    default:
+      return 0;
+  }
+}
+
+static uint16_t getBit(const Address &adr, const OptimizedProgram &prog) {
+  if (adr.val >= RAM_SIZE || prog.constant[adr.val]) {
+    return 0;
+  }
+  return 1 << adr.val;
+}
+
+/*
+ * Whether instruction does anything besides writing to variables, like
+ * reading input, sending output or jumping.
+ */
+static bool hasSideEffects(const OptimizedInstruction &inst) {
+  bool usesIo = inst.adr.val == LAST_ADDRESS;
+  switch (inst.opcode) {
+    case READ:
+    case WRITE:
+    case ADD:
+    case SUB:
+    case AND:
+    case OR:
+    case XOR:
+      return usesIo;
+    case NOT:
+    case SHIFT_L:
+    case SHIFT_R:
+    case INIT:
+    case INC:
+    case DEC:
+      return false;
+    default:
+      return true;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <array>
+#include <stdint.h>
+
+#include "address.hpp"
+#include "const.hpp"
+#include "isa.hpp"
+#include "ram.hpp"
+
+using namespace std;
+
+// Bit of the register in liveness masks. Bits below it stand for the data
+// addresses.
+const uint16_t REG_BIT = 1 << RAM_SIZE;
+
+/*
+ * Instruction with addresses resolved as far as the analysis allows. For
+ * example pointer whose value never changes turns it into a plain READ or
+ * WRITE, and a branch with known register into a JUMP.
+ */
+struct OptimizedInstruction {
+  Opcode opcode;
+  Address adr;
+  // Only used by INIT.
+  Address secondAdr;
+  bool reachable;
+  // Dead store, or a branch that is never taken.
+  bool removed;
+};
+
+struct OptimizedProgram {
+  array<OptimizedInstruction, RAM_SIZE> code;
+  // Data words that program never writes to, so they can be inlined.
+  array<bool, RAM_SIZE> constant;
+  // Whether some data or code address only gets known at run time.
+  bool dynamicData;
+  bool dynamicJumps;
+  // Variables that get read before they get written, if execution
+  // continues from the address. Last element stands for the last address.
+  array<uint16_t, RAM_SIZE+1> liveIn;
+};
+
+/*
+ * Analyses the program before it gets converted to C++ by the Parser.
+ * Does reachability analysis, constant propagation of data words and
+ * register, and elimination of dead stores.
+ */
+class Optimizer {
+  public:
+    static OptimizedProgram optimize(const Ram &ram);
+
+  private:
+    static void propagateConstants(const Ram &ram, OptimizedProgram &prog);
+    static bool removeWrittenConstants(OptimizedProgram &prog);
+    static void eliminateDeadStores(OptimizedProgram &prog);
+    static void computeLiveness(OptimizedProgram &prog);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "parallel_chain.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch_mode.hpp"
+#include "ring_buffer.hpp"
+#include "scheduler.hpp"
+
+using namespace std;
+
+// Buffer that the computer running on this thread writes to. Fibers keep
+// their own.
+static thread_local RingBuffer *stageOutput = NULL;
+
+// Names of the programs that got stuck, indexed by their markers.
+static mutex stuckMutex;
+static vector<string> stuckNames;
+
+static string getStuckName(int marker) {
+  lock_guard<mutex> lock(stuckMutex);
+  return stuckNames[STUCK_IN_LOOP - marker];
+}
+
+static void exitStuck(const string &name) {
+  fprintf(stderr, "Program '%s' got stuck in an endless loop, that "
+          "doesn't produce any output.\n", name.c_str());
+  BatchMode::failJob(7);
+  exit(7);
+}
+
+void ParallelChain::runStage(ProvidesOutput *source, RingBuffer *output) {
+  Fiber *fiber = Scheduler::getCurrentFiber();
+  if (fiber != NULL) {
+    fiber->stageOutput = output;
+  } else {
+    stageOutput = output;
+  }
+  while (true) {
+    int word = source->getOutput();
+    if (word == NO_OUTPUT) {
+      ParallelChain::stop(NO_OUTPUT);
+    }
+    output->push(word);
+  }
+}
+
+void ParallelChain::run(vector<Computer> &computerChain, PipeInput &input,
+                        StandardOutput &output, size_t fiberWorkers) {
+  bool usesFibers = fiberWorkers > 0 && Scheduler::isAvailable();
+  vector<unique_ptr<RingBuffer>> buffers;
+  for (size_t i = 0; i < computerChain.size(); i++) {
+    buffers.push_back(unique_ptr<RingBuffer>(new RingBuffer(usesFibers)));
+    if (i > 0) {
+      computerChain[i].ram.input = buffers[i-1].get();
+    }
+  }
+  // Only the calling thread may flush the output, except when a stage
+  // exits the program because of an error.
+  input.output = NULL;
+  output.finishAtExit();
+  if (usesFibers) {
+    // Input gets read on its own thread, since a blocking read would stop
+    // all fibers of the worker, including the one that prints output.
+    RingBuffer inputBuffer(true);
+    computerChain[0].ram.input = &inputBuffer;
+    thread(runStage, &input, &inputBuffer).detach();
+    Scheduler scheduler(fiberWorkers);
+    for (size_t i = 0; i < computerChain.size(); i++) {
+      scheduler.spawn(bind(runStage, &computerChain[i], buffers[i].get()),
+                      false);
+    }
+    scheduler.spawn(bind(printAll, ref(*buffers.back()), ref(output)), true);
+    scheduler.run();
+    exit(0);
+  }
+  // Threads don't need to be joined, since program ends when output ends.
+  for (size_t i = 0; i < computerChain.size(); i++) {
+    thread(runStage, &computerChain[i], buffers[i].get()).detach();
+  }
+  printAll(*buffers.back(), output);
+  exit(0);
+}
+
+void ParallelChain::printAll(RingBuffer &buffer, StandardOutput &output) {
+  while (true) {
+    if (buffer.isEmpty()) {
+      output.flush();
+    }
+    int word = buffer.pop();
+    if (word == END_OF_INPUT) {
+      output.newlineAtEnd = true;
+    }
+    if (word <= STUCK_IN_LOOP) {
+      output.finish();
+      exitStuck(getStuckName(word));
+    }
+    if (word < 0) {
+      output.finish();
+      return;
+    }
+    output.print(word);
+  }
+}
+
+void ParallelChain::stop(int marker) {
+  Fiber *fiber = Scheduler::getCurrentFiber();
+  if (fiber != NULL) {
+    fiber->stageOutput->push(marker);
+    Scheduler::exitFiber();
+  }
+  if (stageOutput == NULL) {
+    // Doesn't return if thread is running a batch job.
+    BatchMode::endJob();
+    exit(0);
+  }
+  stageOutput->push(marker);
+  while (true) {
+    this_thread::sleep_for(chrono::hours(1));
+  }
+}
+
+void ParallelChain::stopStuck(const string &name) {
+  if (Scheduler::getCurrentFiber() == NULL && stageOutput == NULL) {
+    exitStuck(name);
+  }
+  int marker;
+  {
+    lock_guard<mutex> lock(stuckMutex);
+    marker = STUCK_IN_LOOP - (int) stuckNames.size();
+    stuckNames.push_back(name);
+  }
+  stop(marker);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef PARALLEL_CHAIN_H
+#define PARALLEL_CHAIN_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "computer.hpp"
+#include "pipe_input.hpp"
+#include "provides_output.hpp"
+#include "standard_output.hpp"
+
+using namespace std;
+
+class RingBuffer;
+
+/*
+ * Runs each computer of the chain on its own thread. Consecutive computers
+ * are connected with ring buffers, so a computer can keep working while
+ * the next one processes its previous output. The calling thread prints
+ * the output of the last computer. Computers can also run as fibers, on
+ * the passed number of worker threads.
+ */
+class ParallelChain {
+  public:
+    static void run(vector<Computer> &computerChain, PipeInput &input,
+                    StandardOutput &output, size_t fiberWorkers);
+    // Keeps passing words from the source to the buffer, until the source
+    // stops. Meant to run on its own thread.
+    static void runStage(ProvidesOutput *source, RingBuffer *output);
+    // Prints words from the buffer until it gets the end marker.
+    static void printAll(RingBuffer &buffer, StandardOutput &output);
+    // Called when a computer stops, or its input runs out. Passes the
+    // marker down the chain and puts the calling thread to sleep (or ends
+    // the fiber), so the computers after it can still process the words
+    // they already got.
+    // Outside of parallel chain it ends the batch job or exits the
+    // program.
+    static void stop(int marker);
+    // Called when a computer gets stuck in a loop that doesn't produce any
+    // output. Stage could have run further than the sequential chain would
+    // take it, so the error gets passed down the chain and is reported
+    // only if the output reaches it. Outside of parallel chain it gets
+    // reported right away.
+    static void stopStuck(const string &name);
+};
+
+#endif
\ No newline at end of file
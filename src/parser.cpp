@@ -6,14 +6,16 @@
 
 #include "const.hpp"
 #include "environment_const_string.hpp"
-#include "instruction.hpp"
+#include "isa.hpp"
 #include "load.hpp"
+#include "optimizer.hpp"
 #include "ram.hpp"
+#include "util.hpp"
 
 using namespace std;
 
 string Parser::parse(vector<string> filenamesIn, bool outputChars, 
-                     bool inputChars, bool rawInput) {
+                     bool inputChars, bool rawInput, bool binary) {
   vector<Ram> rams = vector<Ram>(filenamesIn.size());
   // Fills rams with contents of files.
   for (size_t i = 0; i < filenamesIn.size(); i++) {
@@ -28,6 +30,8 @@ string Parser::parse(vector<string> filenamesIn, bool outputChars,
   source += SOURCE_HEADER + "\n\n";
   if (rawInput) {
     source += PRINT_RAW + "\n\n";
+  } else if (binary) {
+    source += PRINT_BINARY + "\n\n";
   } else if (outputChars) {
     source += PRINT_OUTPUT_CHARS + "\n\n";
   } else {
@@ -35,62 +39,268 @@ string Parser::parse(vector<string> filenamesIn, bool outputChars,
   }
   if (rawInput) {
     source += F0_RAW + "\n\n";
+  } else if (binary) {
+    source += F0_BINARY + "\n\n";
   } else if (inputChars) {
     source += F0_INPUT_CHARS + "\n\n";
   } else {
     source += F0_BASIC + "\n\n";
   }
-  for (size_t i = 0; i < filenamesIn.size(); i++) {
-    source += getComputerFunction(rams[i], i)+ "\n\n";
-  }
+  source += getRunFunction(rams) + "\n\n";
   if (rawInput) {
-    source += SOURCE_FOOTER_1_RAW;
+    source += SOURCE_FOOTER_RAW + "\n";
   } else {
-    source += SOURCE_FOOTER_1;
+    source += SOURCE_FOOTER + "\n";
   }
-  source += to_string(filenamesIn.size()) + 
-            SOURCE_FOOTER_2 + "\n";
   return source;
 }
 
-string Parser::getComputerFunction(Ram ram, int index) {
-  string function;
-  function += getFunctionHeader(ram.state[DATA], index)+ "\n";
-  for (size_t i = 0; i < RAM_SIZE; i++) {
-    function += getLineOfCode(ram.state[CODE][i], i, ram) + "\n";
-  }
-  function += SOURCE_FUNCTION_FOOTER;
-  return function;
+/*
+ * Converts all computers into a single function, where each computer is a
+ * coroutine. When computer needs a word from input, it jumps to where its
+ * predecessor stopped. Predecessor jumps back to the reading instruction
+ * when it sends a word to output. First computer reads with 'f0()', and
+ * the last one prints its output.
+ */
+string Parser::getRunFunction(const vector<Ram> &rams) {
+  int numOfComputers = rams.size();
+  vector<OptimizedProgram> progs;
+  for (const Ram &ram : rams) {
+    progs.push_back(Optimizer::optimize(ram));
+  }
+  // Computers get converted from last to first, because each one needs to
+  // know where its successor reads input.
+  string code;
+  vector<string> readLabels;
+  vector<size_t> numOfReads(numOfComputers + 1);
+  for (int i = numOfComputers-1; i >= 0; i--) {
+    vector<string> ownReadLabels;
+    code = getComputerCode(rams[i].state[DATA], progs[i], i+1,
+                           i == numOfComputers-1, readLabels,
+                           ownReadLabels) + code;
+    readLabels = ownReadLabels;
+    numOfReads[i] = readLabels.size();
+  }
+  string function = SOURCE_RUN_HEADER;
+  for (int i = 0; i < numOfComputers; i++) {
+    function += getDeclarations(rams[i].state[DATA], progs[i], i+1,
+                                i == numOfComputers-1, numOfReads[i+1]);
+  }
+  function += "\n  goto " + getLabel(numOfComputers, FIRST_ADDRESS) + ";\n";
+  return function + code + "}";
 }
 
-string Parser::getFunctionHeader(vector<vector<bool>> data, int index) {
-  return SOURCE_FUNCTION_HEADER_1 + to_string(index+1) + 
-         SOURCE_FUNCTION_HEADER_2 + to_string(index) +
-         SOURCE_FUNCTION_HEADER_3 + getData(data) +
-         SOURCE_FUNCTION_HEADER_4;
+/*
+ * Variables of one computer. Data words that never change are inlined,
+ * and the others become separate variables, unless program accesses them
+ * through pointers.
+ */
+string Parser::getDeclarations(const RamBank &data,
+                               const OptimizedProgram &prog, int computer,
+                               bool isLast, size_t numOfSuccessorReads) {
+  string id = to_string(computer);
+  string out;
+  if (prog.dynamicJumps) {
+    out += "  static void * const a" + id + "[16] = { ";
+    for (int i = 0; i <= RAM_SIZE; i++) {
+      out += (i == 0 ? "&&" : ", &&") + getLabel(computer, i);
+    }
+    out += " };\n";
+  }
+  out += "  unsigned char reg" + id + " = 0;\n";
+  if (prog.dynamicData) {
+    out += "  unsigned char data" + id + "[15] = { " + getData(data) +
+           " };\n";
+    out += "  unsigned char adr" + id + ";\n";
+  } else {
+    for (int i = 0; i < RAM_SIZE; i++) {
+      if (!prog.constant[i]) {
+        out += "  unsigned char " + getVariable(prog, Address(DATA, i),
+                                                computer) +
+               " = " + to_string(data[i]) + ";\n";
+      }
+    }
+  }
+  if (isLast) {
+    return out;
+  }
+  // Where computer continues when its output is needed, and where it jumps
+  // after sending a word, if successor reads input in more than one place.
+  out += "  void *resume" + id + " = &&" +
+         getLabel(computer, FIRST_ADDRESS) + ";\n";
+  if (numOfSuccessorReads > 1) {
+    out += "  void *return" + id + ";\n";
+  }
+  return out;
 }
 
-string Parser::getData(vector<vector<bool>> data) {
+string Parser::getData(const RamBank &data) {
   string out;
   bool first = true;
-  for (vector<bool> word : data) {
+  for (uint8_t word : data) {
     if (first) {
       first = false;
-      out += to_string(Util::getInt(word));
+      out += to_string(word);
     } else {
-      out += ", " + to_string(Util::getInt(word));
+      out += ", " + to_string(word);
     }
   }
   return out;
 }
 
-string Parser::getLineOfCode(vector<bool> word, int index, Ram ram) {
-  Instruction inst = Instruction(word, EMPTY_WORD, &ram);
-  string strIndex;
-  if (index < 10) {
-    strIndex = "0";
-  }
-  strIndex += to_string(index);
-  string instCode = inst.getCode(index+1);
-  return "  a" + strIndex + ": " + instCode;
+/*
+ * Code of one computer. Labels of instructions that read input get
+ * appended to 'ownReadLabels'. If there is only one, predecessor jumps
+ * straight to it.
+ */
+string Parser::getComputerCode(const RamBank &data,
+                               const OptimizedProgram &prog, int computer,
+                               bool isLast,
+                               const vector<string> &readLabels,
+                               vector<string> &ownReadLabels) {
+  string code;
+  for (int i = 0; i < RAM_SIZE; i++) {
+    if (prog.code[i].reachable) {
+      code += getLineOfCode(data, prog, i, computer, isLast, readLabels,
+                            ownReadLabels) + "\n";
+    }
+  }
+  code += "  " + getLabel(computer, LAST_ADDRESS) + ": exit(0);\n";
+  if (ownReadLabels.size() == 1) {
+    code = Util::replaceAll(code, "return" + to_string(computer-1) +
+                            " = &&" + ownReadLabels[0] + "; ", "");
+  }
+  return code;
+}
+
+/*
+ * Fills in the code template of the instruction. Constant data words get
+ * inlined, and jumps with known address go straight to the label.
+ */
+string Parser::getLineOfCode(const RamBank &data,
+                             const OptimizedProgram &prog, int index,
+                             int computer, bool isLast,
+                             const vector<string> &readLabels,
+                             vector<string> &ownReadLabels) {
+  const OptimizedInstruction &inst = prog.code[index];
+  string line = "  " + getLabel(computer, index) + ": ";
+  if (inst.removed) {
+    return line + ";";
+  }
+  const IsaEntry &entry = Isa::get(inst.opcode);
+  bool isIo = inst.adr.val == LAST_ADDRESS;
+  string code = (isIo && entry.ioCode != NULL) ? entry.ioCode : entry.code;
+  bool readsOperand = isIo && code.find("$OP") != string::npos;
+  string id = to_string(computer);
+  code = Util::replaceAll(code, "goto *a[$ADR]",
+                          "goto " + getLabel(computer, inst.adr.val));
+  code = Util::replaceAll(code, "data[$ADR2]",
+                          getOperand(data, prog, inst.secondAdr, computer));
+  code = Util::replaceAll(code, "data[$ADR]",
+                          getOperand(data, prog, inst.adr, computer));
+  code = Util::replaceAll(code, "$OP",
+                          getOperand(data, prog, inst.adr, computer));
+  code = Util::replaceAll(code, "pc = $PC; ", "");
+  code = Util::replaceAll(code, "$MAX", to_string(MAX_VALUE));
+  code = Util::replaceAll(code, "$SIZE", to_string(RAM_SIZE));
+  code = Util::replaceAll(code, "reg", "reg" + id);
+  code = Util::replaceAll(code, "adr", "adr" + id);
+  code = Util::replaceAll(code, "data[", "data" + id + "[");
+  code = Util::replaceAll(code, "*a[", "*a" + id + "[");
+  // Pointer that points to the IN/OUT address.
+  if (code.find("predecesor()") != string::npos) {
+    code = Util::replaceAll(code, "reg" + id + " = predecesor();",
+                            "{ " + getRead(computer, ownReadLabels) + "reg" +
+                            id + " = " + getInput(computer) + "; }");
+  }
+  if (readsOperand) {
+    code = getRead(computer, ownReadLabels) + code;
+  }
+  size_t returnIndex = code.find("return ");
+  if (returnIndex != string::npos) {
+    size_t wordIndex = returnIndex + 7;
+    size_t endIndex = code.find(';', wordIndex);
+    string word = code.substr(wordIndex, endIndex - wordIndex);
+    code = code.substr(0, returnIndex) +
+           getWrite(word, index, computer, isLast, readLabels) +
+           code.substr(endIndex + 1);
+  }
+  return line + code;
+}
+
+string Parser::getLabel(int computer, int index) {
+  return "c" + to_string(computer) + "_a" + (index < 10 ? "0" : "") +
+         to_string(index);
+}
+
+/*
+ * Jumps to the predecessor, that jumps back to the new label once it sends
+ * the word. First computer just calls 'f0()'.
+ */
+string Parser::getRead(int computer, vector<string> &ownReadLabels) {
+  if (computer == 1) {
+    return "";
+  }
+  string prev = to_string(computer-1);
+  string label = "c" + to_string(computer) + "_r" +
+                 to_string(ownReadLabels.size());
+  ownReadLabels.push_back(label);
+  return "return" + prev + " = &&" + label + "; goto *resume" + prev +
+         "; " + label + ": ";
+}
+
+string Parser::getInput(int computer) {
+  return computer == 1 ? "f0()" : "word";
+}
+
+/*
+ * Passes the word to the successor, and remembers where to continue, or
+ * prints it if this is the last computer.
+ */
+string Parser::getWrite(const string &word, int index, int computer,
+                        bool isLast, const vector<string> &readLabels) {
+  if (isLast) {
+    return "print(" + word + ");";
+  }
+  string id = to_string(computer);
+  string out = "{ ";
+  if (word != "word") {
+    out += "word = " + word + "; ";
+  }
+  // Successor that never reads input never gives control back to this
+  // computer, so the word can't be consumed and the code is unreachable.
+  if (readLabels.empty()) {
+    return out + "}";
+  }
+  out += "resume" + id + " = &&" + getLabel(computer, index+1) + "; ";
+  if (readLabels.size() == 1) {
+    out += "goto " + readLabels[0] + "; }";
+  } else {
+    out += "goto *return" + id + "; }";
+  }
+  return out;
+}
+
+/*
+ * Value of the data word, the input if address is the IN/OUT address, or
+ * literal if data word never changes.
+ */
+string Parser::getOperand(const RamBank &data, const OptimizedProgram &prog,
+                          const Address &adr, int computer) {
+  if (adr.val == LAST_ADDRESS) {
+    return getInput(computer);
+  }
+  if (prog.constant[adr.val]) {
+    return to_string(data[adr.val]);
+  }
+  return getVariable(prog, adr, computer);
+}
+
+string Parser::getVariable(const OptimizedProgram &prog, const Address &adr,
+                           int computer) {
+  string id = to_string(computer);
+  if (prog.dynamicData) {
+    return "data" + id + "[" + to_string(adr.val) + "]";
+  }
+  return "d" + id + "_" + to_string(adr.val);
 }
\ No newline at end of file
@@ -1,22 +1,46 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 
-using namespace std;
+#include "address.hpp"
+#include "optimizer.hpp"
+#include "ram.hpp"
 
-class Ram;
+using namespace std;
 
 class Parser {
   public:
     static string parse(vector<string> filenamesIn, bool outputChars, 
-                        bool inputChars, bool rawInput);
+                        bool inputChars, bool rawInput, bool binary);
   private:
-    static string getComputerFunction(Ram ram, int index);
-    static string getFunctionHeader(vector<vector<bool>> data, int index);
-    static string getData(vector<vector<bool>> data);
-    static string getLineOfCode(vector<bool> word, int index, Ram ram);
+    static string getRunFunction(const vector<Ram> &rams);
+    static string getDeclarations(const RamBank &data,
+                                  const OptimizedProgram &prog, int computer,
+                                  bool isLast, size_t numOfSuccessorReads);
+    static string getData(const RamBank &data);
+    static string getComputerCode(const RamBank &data,
+                                  const OptimizedProgram &prog, int computer,
+                                  bool isLast,
+                                  const vector<string> &readLabels,
+                                  vector<string> &ownReadLabels);
+    static string getLineOfCode(const RamBank &data,
+                                const OptimizedProgram &prog, int index,
+                                int computer, bool isLast,
+                                const vector<string> &readLabels,
+                                vector<string> &ownReadLabels);
+    static string getLabel(int computer, int index);
+    static string getRead(int computer, vector<string> &ownReadLabels);
+    static string getInput(int computer);
+    static string getWrite(const string &word, int index, int computer,
+                           bool isLast, const vector<string> &readLabels);
+    static string getOperand(const RamBank &data,
+                             const OptimizedProgram &prog,
+                             const Address &adr, int computer);
+    static string getVariable(const OptimizedProgram &prog,
+                              const Address &adr, int computer);
 };
 
 #endif
@@ -1,6 +1,9 @@
 #include "pipe_input.hpp"
 
 #include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
 #include <iostream>
 #include <cstdio>
 
@@ -9,7 +12,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 
-#include "util.hpp"
+#include "parallel_chain.hpp"
 
 using namespace std;
 
@@ -17,20 +20,123 @@ extern "C" {
   extern volatile sig_atomic_t pleaseExit;
 }
 
-vector<bool> PipeInput::getOutput() {
+int PipeInput::getOutput() {
   if (rawMode) {
-    char c = readRawChar();
-    return Util::getBoolByte((int)c);
+    return (unsigned char) readRawChar();
   } else if (inputChars) {
-    int c = getchar();
+    int c = readChar();
     if (c == EOF) {
-      cout << endl;
-      exit(0);
+      if (binary) {
+        ParallelChain::stop(NO_OUTPUT);
+      }
+      if (output != NULL) {
+        output->newlineAtEnd = true;
+      }
+      ParallelChain::stop(END_OF_INPUT);
+    }
+    return c;
+  } else {
+    int word = readWord();
+    // Chain stops when end of pipe input is reached.
+    if (word == EOF) {
+      ParallelChain::stop(NO_OUTPUT);
+    }
+    return word;
+  }
+}
+
+/*
+ * Input will consist only of the passed record, and it will end after it.
+ */
+void PipeInput::setRecord(const char *record, size_t size) {
+  data = record;
+  position = 0;
+  length = size;
+  readingStdin = false;
+}
+
+/*
+ * Input will be read from the mapped file instead of stdin, without
+ * copying it.
+ */
+void PipeInput::readFromFile(const string &filename) {
+  file = make_shared<MappedInputFile>(filename);
+  setRecord(file->data, file->size);
+}
+
+/*
+ * Input will be read from the descriptor instead of stdin.
+ */
+void PipeInput::readFromDescriptor(int fd) {
+  descriptor = fd;
+}
+
+/*
+ * Reads next block of stdin into the buffer. Returns false when end of
+ * input is reached.
+ */
+bool PipeInput::fillBuffer() {
+  if (!readingStdin) {
+    return false;
+  }
+  flushOutput();
+  ssize_t num;
+  do {
+    errno = 0;
+    num = read(descriptor, buffer.data(), buffer.size());
+  } while (num == -1 && errno == EINTR);
+  data = buffer.data();
+  position = 0;
+  length = max(num, (ssize_t) 0);
+  return length > 0;
+}
+
+void PipeInput::flushOutput() {
+  if (output != NULL) {
+    output->flush();
+  }
+}
+
+int PipeInput::readChar() {
+  if (position == length && !fillBuffer()) {
+    return EOF;
+  }
+  return (unsigned char) data[position++];
+}
+
+/*
+ * Parses next whitespace separated word directly from the buffer. Words
+ * that start with a digit are read as numbers, and numbers larger than max
+ * value get saturated. Otherwise every '*' is interpreted as true and all
+ * other characters as false.
+ */
+int PipeInput::readWord() {
+  int c = readChar();
+  while (isspace(c)) {
+    c = readChar();
+  }
+  if (c == EOF) {
+    return EOF;
+  }
+  int out = 0;
+  if (isdigit(c)) {
+    while (isdigit(c)) {
+      out = min(out * 10 + c - '0', MAX_VALUE);
+      c = readChar();
     }
-    return Util::getBoolByte(c);
   } else {
-    return Util::readWordFromPipe();
+    for (int i = 0; i < WORD_SIZE && c != EOF && !isspace(c); i++) {
+      if (c == '*') {
+        out |= 0x80 >> i;
+      }
+      c = readChar();
+    }
+  }
+  // Skips the rest of the word.
+  while (c != EOF && !isspace(c)) {
+    c = readChar();
   }
+  return out;
 }
 
 char PipeInput::readRawChar() {
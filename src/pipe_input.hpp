@@ -1,7 +1,15 @@
 #ifndef PIPE_INPUT_H
 #define PIPE_INPUT_H
 
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "const.hpp"
+#include "mapped_file.hpp"
 #include "provides_output.hpp"
+#include "standard_output.hpp"
 
 using namespace std;
 
@@ -11,18 +19,44 @@ extern "C" {
 
 class PipeInput : public ProvidesOutput {
   public:
-    PipeInput(bool inputCharsIn, bool rawModeIn) 
-        : inputChars(inputCharsIn), rawMode(rawModeIn) {
+    PipeInput(bool inputCharsIn, bool rawModeIn, bool binaryIn) 
+        : inputChars(inputCharsIn), rawMode(rawModeIn), binary(binaryIn),
+          buffer(vector<char>(INPUT_BUFFER_SIZE)) {
       if (rawMode) {
         setEnvironment();
       }
     }
-    vector<bool> getOutput();
+    int getOutput();
+    void setRecord(const char *record, size_t size);
+    void readFromFile(const string &filename);
+    void readFromDescriptor(int fd);
+
+    // Gets flushed before waiting for more input. Not set in parallel
+    // chain, where output is printed by another thread.
+    StandardOutput *output = NULL;
 
   private:
     bool inputChars;
     bool rawMode;
+    // Output doesn't end with a new line when binary input runs out.
+    bool binary;
+    // Bytes that were not yet consumed are kept between 'position' and
+    // 'length' of 'data', that points either to the buffer with the last
+    // block of stdin, or to the whole input if it's in memory.
+    vector<char> buffer;
+    const char *data = NULL;
+    size_t position = 0;
+    size_t length = 0;
+    // Not set when input is a record from batch mode or a mapped file.
+    bool readingStdin = true;
+    // Read instead of stdin, if set. Used by server for client's socket.
+    int descriptor = 0;
+    shared_ptr<MappedInputFile> file;
     char readRawChar();
+    bool fillBuffer();
+    void flushOutput();
+    int readChar();
+    int readWord();
 };
 
 #endif
\ No newline at end of file
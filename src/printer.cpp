@@ -13,8 +13,8 @@ using namespace std;
 
 void Printer::run() {
   while (1) {
-    vector<bool> out = input.getOutput();
-    if (out.empty()) {
+    int out = input.getOutput();
+    if (out == NO_OUTPUT) {
       printEmptyLine();
       printState();
       return;
@@ -56,8 +56,8 @@ void Printer::printString(string sIn) {
  * then prints to the stdout. If stdout is a pipe, then it doesen't
  * add the decimal representation.
  */
-void Printer::print(vector<bool> wordIn) {
-  output += Util::getStringWithFormatedInt(wordIn);
+void Printer::print(uint8_t wordIn) {
+  output += Util::getStringWithFormatedInt(Util::getBoolByte(wordIn));
   printerOutputUpdated = false;
 }
 
@@ -1,6 +1,7 @@
 #ifndef PRINTER_H
 #define PRINTER_H
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -30,7 +31,7 @@ class Printer {
     mutable bool printerOutputUpdated = false;
 
     /// PRIVATE ///
-    void print(vector<bool> sIn);
+    void print(uint8_t wordIn);
     void printEmptyLine();
     string getOutput();
     void clear();
@@ -0,0 +1,116 @@
+#include "profile.hpp"
+
+#include <stdio.h>
+#include <string>
+
+#include "instruction.hpp"
+#include "util.hpp"
+
+using namespace std;
+
+void Profile::countInstruction(uint8_t pc, Opcode opcode,
+                               const Address &firstOrderAdr,
+                               const Address &adr) {
+  cycles++;
+  hits[pc]++;
+  const IsaEntry &entry = Isa::get(opcode);
+  if (entry.operandKind == POINTER_OPERAND) {
+    countRead(firstOrderAdr);
+  }
+  switch (entry.access) {
+    case NO_ACCESS:
+      break;
+    case READS_ADR:
+      countRead(adr);
+      break;
+    case WRITES_ADR:
+      countWrite(adr);
+      break;
+    case UPDATES_ADR:
+      countRead(adr);
+      countWrite(adr);
+      break;
+    case COPIES_TO_ADR:
+      countRead(Address(DATA, entry.secondFixedAdr));
+      countWrite(adr);
+      break;
+    case PRINTS_ADR:
+      countRead(adr);
+      countWrite(Address(DATA, LAST_ADDRESS));
+      break;
+  }
+}
+
+/*
+ * Gap before the first I/O event doesn't get counted.
+ */
+void Profile::countIo() {
+  if (ioEvents++ == 0) {
+    firstIoCycle = cycles;
+  } else {
+    unsigned long gap = cycles - lastIoCycle;
+    int bucket = 0;
+    while (gap >> (bucket + 1) != 0) {
+      bucket++;
+    }
+    ioGaps[bucket]++;
+    maxIoGap = max(maxIoGap, gap);
+  }
+  lastIoCycle = cycles;
+}
+
+string Profile::getListing(const string &name, const RamBank &code) const {
+  char line[128];
+  snprintf(line, sizeof(line), "Profile of '%s': %lu cycles\n",
+           name.c_str(), cycles);
+  string out = line;
+  out += "  adr  word      instruction       hits       %\n";
+  for (int i = 0; i < RAM_SIZE; i++) {
+    if (code[i] == EMPTY_WORD && hits[i] == 0) {
+      continue;
+    }
+    Instruction inst = Instruction(code[i], EMPTY_WORD, NULL);
+    snprintf(line, sizeof(line), "  %3d  %s  %-12s %10lu  %5.1f%%\n", i,
+             Util::getString(Util::getBoolByte(code[i])).c_str(),
+             inst.getText().c_str(), hits[i],
+             cycles > 0 ? 100.0 * hits[i] / cycles : 0.0);
+    out += line;
+  }
+  out += "  data       reads     writes\n";
+  for (int i = 0; i <= RAM_SIZE; i++) {
+    if (reads[i] == 0 && writes[i] == 0) {
+      continue;
+    }
+    snprintf(line, sizeof(line), "  %-4s  %10lu %10lu\n",
+             i == RAM_SIZE ? "I/O" : to_string(i).c_str(), reads[i],
+             writes[i]);
+    out += line;
+  }
+  if (ioEvents > 1) {
+    snprintf(line, sizeof(line), "  cycles between I/O events: mean %.1f, "
+             "max %lu\n", (double) (lastIoCycle - firstIoCycle) /
+             (ioEvents - 1), maxIoGap);
+    out += line;
+    for (size_t i = 0; i < ioGaps.size(); i++) {
+      if (ioGaps[i] == 0) {
+        continue;
+      }
+      unsigned long from = 1ul << i;
+      unsigned long to = (from << 1) - 1;
+      snprintf(line, sizeof(line), "  %10lu - %-10lu %10lu\n", from, to,
+               ioGaps[i]);
+      out += line;
+    }
+  }
+  return out;
+}
+
+/// PRIVATE ///
+
+void Profile::countRead(const Address &adr) {
+  reads[adr.val & LAST_ADDRESS]++;
+}
+
+void Profile::countWrite(const Address &adr) {
+  writes[adr.val & LAST_ADDRESS]++;
+}
\ No newline at end of file
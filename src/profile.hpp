@@ -0,0 +1,49 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include <array>
+#include <string>
+
+#include "address.hpp"
+#include "const.hpp"
+#include "isa.hpp"
+#include "ram.hpp"
+
+using namespace std;
+
+/*
+ * Execution counts of one computer, collected when running with
+ * '--profile'. Profiled program runs in its own loop of the interpreter,
+ * so that engines don't need to check whether they should be counting.
+ */
+class Profile {
+  public:
+    void countInstruction(uint8_t pc, Opcode opcode,
+                          const Address &firstOrderAdr, const Address &adr);
+    // Called after an instruction that read input or wrote output.
+    void countIo();
+    // Code words with their labels and hit counts, reads and writes of
+    // data addresses, and cycles between I/O events.
+    string getListing(const string &name, const RamBank &code) const;
+
+  private:
+    // Executions of each code address.
+    array<unsigned long, RAM_SIZE> hits = {};
+    // Last address is IN/OUT, where reads are input and writes output.
+    array<unsigned long, RAM_SIZE+1> reads = {};
+    array<unsigned long, RAM_SIZE+1> writes = {};
+    unsigned long cycles = 0;
+    unsigned long ioEvents = 0;
+    unsigned long firstIoCycle = 0;
+    unsigned long lastIoCycle = 0;
+    unsigned long maxIoGap = 0;
+    // Numbers of gaps between consecutive I/O events, where gaps of 'n'
+    // cycles get counted under the index of the highest set bit of 'n'.
+    array<unsigned long, 64> ioGaps = {};
+
+    void countRead(const Address &adr);
+    void countWrite(const Address &adr);
+};
+
+#endif
\ No newline at end of file
@@ -1,14 +1,22 @@
 #ifndef PROVIDES_OUTPUT_H
 #define PROVIDES_OUTPUT_H
 
-#include <vector>
-
 using namespace std;
 
+// Returned by getOutput() when there is no more output.
+const int NO_OUTPUT = -1;
+// Passed down the parallel chain in place of a word, when stdin ends in
+// char mode.
+const int END_OF_INPUT = -2;
+// Passed down the parallel chain in place of a word, when a program gets
+// stuck in a loop without output. Markers below it tell which program.
+const int STUCK_IN_LOOP = -3;
+
 class ProvidesOutput {
   public:
     virtual ~ProvidesOutput() {}
-    virtual vector<bool> getOutput() = 0;  // const = 0;
+    // Returns next word (0-255), or NO_OUTPUT.
+    virtual int getOutput() = 0;  // const = 0;
 };
 
 #endif
\ No newline at end of file
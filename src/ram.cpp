@@ -4,6 +4,7 @@
 #include <string>
 
 #include "address.hpp"
+#include "batch_mode.hpp"
 #include "const.hpp"
 #include "provides_output.hpp"
 #include "util.hpp"
@@ -12,32 +13,22 @@ using namespace std;
 
 ////// INTERFACE //////
 
-vector<bool> Ram::get(const Address &adr) const {
-  AddrSpace space = adr.space;
-  vector<bool> value = adr.val;
+uint8_t Ram::get(const Address &adr) const {
   // Only looks at last 4 bits of passed address.   
-  vector<bool> adrShaved(value.end() - ADDR_SIZE, value.end());
-  int adrIndex = Util::getInt(adrShaved);
+  int adrIndex = adr.val & LAST_ADDRESS;
   if (adrIndex == RAM_SIZE) {
-    return Ram::getLastAddress(space);
+    return Ram::getLastAddress(adr.space);
   }
-  return state.at(space).at(adrIndex);
+  return state[adr.space][adrIndex];
 }
 
-void Ram::set(const Address &adr, const vector<bool> &wordIn) {
-  AddrSpace space = adr.space;
-  vector<bool> value = adr.val;
-  if (wordIn.size() != WORD_SIZE) {
-    fprintf(stderr, "Error in function Ram::set, invalid length of word");
-    exit(6);
-  }
+void Ram::set(const Address &adr, uint8_t wordIn) {
   // Only looks at last 4 bits of passed address.   
-  vector<bool> adrShaved(value.end() - ADDR_SIZE, value.end());
-  int adrIndex = Util::getInt(adrShaved);
+  int adrIndex = adr.val & LAST_ADDRESS;
   if (adrIndex < RAM_SIZE) {
-    saveWord(space, adrIndex, wordIn);
+    state[adr.space][adrIndex] = wordIn;
   } else {
-    assignToLastAddress(space, wordIn);
+    assignToLastAddress(adr.space, wordIn);
   }
 }
 
@@ -45,36 +36,34 @@ string Ram::getString() const {
   return stateToString(state);
 }
 
-string Ram::stateToString(map<AddrSpace, vector<vector<bool>>> state) {
+string Ram::stateToString(const RamState &state) {
   string out;
   out += "# Code:\n";
-  out += spaceToString(state.at(CODE));
+  out += spaceToString(state[CODE]);
   out += "\n# Data:\n";
-  out += spaceToString(state.at(DATA));
+  out += spaceToString(state[DATA]);
   return out;
 }
 
 /// PRIVATE ///
 
-vector<bool> Ram::getLastAddress(AddrSpace addrSpace) const {
+uint8_t Ram::getLastAddress(AddrSpace addrSpace) const {
   if (addrSpace == CODE) {
     fprintf(stderr, "Error in function Ram::getInstruction, "
             "invalid address");
+    BatchMode::failJob(4);
     exit(4);
   } else {
+    inputCount++;
     return input->getOutput();
   }
 }
 
-void Ram::saveWord(AddrSpace addrSpace, int address,
-                   const vector<bool> &wordIn) {
-  state[addrSpace][address] = wordIn;
-}
-
-void Ram::assignToLastAddress(AddrSpace addrSpace, const vector<bool> &wordIn) {
+void Ram::assignToLastAddress(AddrSpace addrSpace, uint8_t wordIn) {
   if (addrSpace == CODE) {
     fprintf(stderr, "Error in function Ram::setInstruction, "
             "Trying to write to last address of code address space.");
+    BatchMode::failJob(5);
     exit(5);
   } else {
     output = wordIn;
@@ -82,10 +71,10 @@ void Ram::assignToLastAddress(AddrSpace addrSpace, const vector<bool> &wordIn) {
   }
 }
 
-string Ram::spaceToString(vector<vector<bool>> space) {
+string Ram::spaceToString(const RamBank &space) {
   string out;
-  for (vector<bool> word : space) {
-    out += Util::getString(word) + '\n';
+  for (uint8_t word : space) {
+    out += Util::getString(Util::getBoolByte(word)) + '\n';
   }
   return out;
 }
\ No newline at end of file
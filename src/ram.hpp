@@ -1,8 +1,9 @@
 #ifndef RAM_H
 #define RAM_H
 
-#include <vector>
-#include <map>
+#include <stdint.h>
+#include <array>
+#include <string>
 
 #include "addr_space.hpp"
 #include "const.hpp"
@@ -12,30 +13,33 @@ using namespace std;
 class Address;
 class ProvidesOutput;
 
+// One address space. Each word is packed into a byte, MSB being the
+// leftmost bit.
+typedef array<uint8_t, RAM_SIZE> RamBank;
+// State of both address spaces, indexed by AddrSpace (CODE, DATA).
+typedef array<RamBank, 2> RamState;
+
 class Ram {
   public:
-    // Initializes the state, one per address space.
-    Ram() {
-      state[CODE] = vector<vector<bool>>(RAM_SIZE, vector<bool>(WORD_SIZE));
-      state[DATA] = vector<vector<bool>>(RAM_SIZE, vector<bool>(WORD_SIZE)); 
-    }
-
-    map<AddrSpace, vector<vector<bool>>> state;
-    vector<bool> output;
+    // Initializes the state, one bank per address space.
+    Ram() : state() { }
+
+    RamState state;
+    uint8_t output = 0;
     bool outputPending = false;
     ProvidesOutput *input = NULL;
+    // Number of words that were read from the input.
+    mutable unsigned long inputCount = 0;
 
-    vector<bool> get(const Address &adr) const;
-    void set(const Address &adr, const vector<bool> &wordIn);
+    uint8_t get(const Address &adr) const;
+    void set(const Address &adr, uint8_t wordIn);
     string getString() const;
-    static string stateToString(map<AddrSpace, vector<vector<bool>>> state);
+    static string stateToString(const RamState &state);
 
   private:
-    vector<bool> getLastAddress(AddrSpace addrSpace) const;
-    // vector<bool> getInput() const;
-    void saveWord(AddrSpace addrSpace, int address, const vector<bool> &wordIn);
-    void assignToLastAddress(AddrSpace addrSpace, const vector<bool> &wordIn);
-    static string spaceToString(vector<vector<bool>> space);
+    uint8_t getLastAddress(AddrSpace addrSpace) const;
+    void assignToLastAddress(AddrSpace addrSpace, uint8_t wordIn);
+    static string spaceToString(const RamBank &space);
 };
 
 #endif
\ No newline at end of file
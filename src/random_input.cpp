@@ -1,9 +1,11 @@
 #include "random_input.hpp"
 
-#include "util.hpp"
+#include <stdlib.h>
+
+#include "const.hpp"
 
 using namespace std;
 
-vector<bool> RandomInput::getOutput() {
-  return Util::getRandomWord();  
+int RandomInput::getOutput() {
+  return rand() % (MAX_VALUE+1);
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include "renderer.hpp"
 
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -207,8 +209,8 @@ void Renderer::highlightOperator(vector<bool> &highlightedLocations,
       exclude = "DEC";
     }
   }
-  string label = " " + inst->label;
-  label.append(11 - inst->label.length(), ' ');  
+  string label = " " + string(inst->label);
+  label.append(12 - label.length(), ' ');  
   highlightLabel(highlightedLocations, lineIn, Util::stringToVecOfString(label), 
                  Util::stringToVecOfString(exclude));
 }
@@ -241,7 +243,7 @@ void Renderer::highlightWord(vector<bool> &highlightedLocations,
   for (size_t i = 0; i < lineIn.size(); i++) {
     if (lineIn[i] == indicator) {
       int addressValue = switchIndex[indicator] / WORD_SIZE;
-      Address adr = Address(addrSpace, Util::getBoolNibb(addressValue));
+      Address adr = Address(addrSpace, addressValue);
       if (instructionPointingToAddress(adr)) {
         highlightedLocations[i] = !highlightedLocations[i];
       }
@@ -284,7 +286,7 @@ bool Renderer::getLightbulb(string cIn) {
   } else if (cIn == DATA_INDICATOR) {
     return getDataBit(i);
   } else if (cIn == REGISTER_INDICATOR) {
-    return cpu.getRegister().at(i);
+    return getBitOfWord(cpu.getRegisterValue(), i);
   } else if (cIn == CODE_ADR_INDICATOR) {
     return getAdrIndicator(CODE, i);
   } else if (cIn == DATA_ADR_INDICATOR) {
@@ -306,7 +308,11 @@ bool Renderer::getDataBit(int i) {
 
 bool Renderer::getBit(AddrSpace space, int i) {
   pair<int, int> coord = convertIndexToCoordinates(i);
-  return ram.state.at(space).at(coord.second).at(coord.first);
+  return getBitOfWord(ram.state[space].at(coord.second), coord.first);
+}
+
+bool Renderer::getBitOfWord(uint8_t word, int i) {
+  return (word >> (WORD_SIZE-1-i)) & 1;
 }
 
 pair<int, int> Renderer::convertIndexToCoordinates(int index) {
@@ -319,11 +325,11 @@ bool Renderer::pcPointingToAddress(int adr) {
   if (executionHasntStarted()) {
     return false;
   }
-  return Util::getInt(cpu.getPc()) == adr;
+  return cpu.getPcValue() == adr;
 }
 
 bool Renderer::getAdrIndicator(AddrSpace addrSpace, int index) {
-  Address indicatorsAddress = Address(addrSpace, Util::getBoolNibb(index));
+  Address indicatorsAddress = Address(addrSpace, index);
   return isAddressReferencedFirstOrder(indicatorsAddress);
 }
 
@@ -364,14 +370,14 @@ bool Renderer::executionHasntStarted() {
 }
 
 bool Renderer::executionEnded() {
-  return Util::getInt(cpu.getPc()) == RAM_SIZE;
+  return cpu.getPcValue() == RAM_SIZE;
 }
 
 Instruction Renderer::initializeInstruction() {
   if (machineActive()) {
     return cpu.getInstruction();
   } else {
-    return Instruction(cursor.getWord(), EMPTY_WORD, &ram);
+    return Instruction(ram.get(cursor.getAddress()), EMPTY_WORD, &ram);
   }
 }
 
@@ -424,7 +430,7 @@ set<int> Renderer::generatePointingInstructions() {
 bool Renderer::isAddressReferencedFirstOrder(Address adr) {
   vector<Instruction> *instructions = getEffectiveInstructions();
   for (Instruction inst : *instructions) {
-    vector<Address> aaa = inst.firstOrderAdr;
+    const array<Address, 2> &aaa = inst.firstOrderAdr;
     bool isReferenced = find(aaa.begin(), aaa.end(), adr) != aaa.end();
     if (isReferenced) {
       return true;
@@ -441,7 +447,7 @@ bool Renderer::isAddressReferencedFirstOrder(Address adr) {
 vector<Instruction>* Renderer::getEffectiveInstructions() {
   if (!effectiveInstructionsInitialized) {
     effectiveInstructions =
-        Instruction::getEffectiveInstructions(ram, cpu.getRegister());
+        Instruction::getEffectiveInstructions(ram, cpu.getRegisterValue());
     effectiveInstructionsInitialized = true;
   }
   return &effectiveInstructions;
@@ -1,6 +1,7 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include <stdint.h>
 #include <map>
 #include <set>
 #include <string>
@@ -17,7 +18,6 @@ class Cursor;
 class Instruction;
 class Printer;
 class Ram;
-class SpecificInstruction;
 class View;
 
 class Renderer {
@@ -88,6 +88,7 @@ class Renderer {
     bool getCodeBit(int i);
     bool getDataBit(int i);
     bool getBit(AddrSpace space, int i);
+    static bool getBitOfWord(uint8_t word, int i);
     static pair<int, int> convertIndexToCoordinates(int index);
     bool pcPointingToAddress(int adr);
     bool getAdrIndicator(AddrSpace addrSpace, int index);
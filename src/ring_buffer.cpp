@@ -0,0 +1,118 @@
+#include "ring_buffer.hpp"
+
+#include <thread>
+
+#include "parallel_chain.hpp"
+
+using namespace std;
+
+void RingBuffer::push(int word) {
+  size_t t = tail.load(memory_order_relaxed);
+  if (t - cachedHead == RING_BUFFER_SIZE) {
+    waitUntil(producerWaiting, producerFiber, [&]() {
+      cachedHead = head.load(memory_order_acquire);
+      return t - cachedHead < RING_BUFFER_SIZE;
+    });
+  }
+  words[t % RING_BUFFER_SIZE] = word;
+  tail.store(t + 1, memory_order_release);
+  wakeUp(consumerWaiting, consumerFiber);
+}
+
+int RingBuffer::pop() {
+  size_t h = head.load(memory_order_relaxed);
+  if (h == cachedTail) {
+    waitUntil(consumerWaiting, consumerFiber, [&]() {
+      cachedTail = tail.load(memory_order_acquire);
+      return h != cachedTail;
+    });
+  }
+  int word = words[h % RING_BUFFER_SIZE];
+  head.store(h + 1, memory_order_release);
+  wakeUp(producerWaiting, producerFiber);
+  return word;
+}
+
+/*
+ * Called by consumer.
+ */
+bool RingBuffer::isEmpty() const {
+  return head.load(memory_order_relaxed) == 
+         tail.load(memory_order_acquire);
+}
+
+int RingBuffer::getOutput() {
+  int word = pop();
+  if (word < 0) {
+    ParallelChain::stop(word);
+  }
+  return word;
+}
+
+/*
+ * Fence pairs with the one in 'wakeUp()', so either producer sees the
+ * fiber, or the fiber sees the pushed word before it parks.
+ */
+void RingBuffer::wakeOnPush() {
+  consumerFiber.store(Scheduler::getCurrentFiber(), memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+}
+
+/// PRIVATE ///
+
+/*
+ * Fence pairs with the one in 'waitUntil()', so either this side sees the
+ * waiting flag or fiber, or the waiting side sees the moved index. Other
+ * side can be a fiber or a thread, even if buffer is used by fibers.
+ */
+void RingBuffer::wakeUp(atomic<bool> &waiting,
+                        atomic<Fiber*> &waitingFiber) {
+  atomic_thread_fence(memory_order_seq_cst);
+  if (usesFibers && waitingFiber.load(memory_order_relaxed) != NULL) {
+    Fiber *fiber = waitingFiber.exchange(NULL);
+    if (fiber != NULL) {
+      Scheduler::wake(fiber);
+    }
+  }
+  if (waiting.load(memory_order_relaxed)) {
+    lock_guard<mutex> lock(waitMutex);
+    progress.notify_all();
+  }
+}
+
+template<typename Condition>
+void RingBuffer::waitUntil(atomic<bool> &waiting,
+                           atomic<Fiber*> &waitingFiber,
+                           Condition condition) {
+  // Fences make sure the other side either sees the fiber, or the fiber
+  // sees its progress. Fiber that got woken up by mistake just checks
+  // again.
+  if (usesFibers && Scheduler::getCurrentFiber() != NULL) {
+    while (!condition()) {
+      waitingFiber.store(Scheduler::getCurrentFiber(),
+                         memory_order_relaxed);
+      atomic_thread_fence(memory_order_seq_cst);
+      if (condition()) {
+        return;
+      }
+      Scheduler::park();
+    }
+    return;
+  }
+  for (int i = 0; i < RING_SPIN_COUNT; i++) {
+    if (condition()) {
+      return;
+    }
+    this_thread::yield();
+  }
+  // Flag is raised before the last check, and the other side takes the
+  // mutex before it notifies, so the notification can't get lost between
+  // the check and the wait.
+  unique_lock<mutex> lock(waitMutex);
+  waiting.store(true, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  while (!condition()) {
+    progress.wait(lock);
+  }
+  waiting.store(false, memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include "const.hpp"
+#include "provides_output.hpp"
+#include "scheduler.hpp"
+
+using namespace std;
+
+/*
+ * Bounded queue of words between two stages of a parallel chain, with
+ * one thread pushing and one popping. Indices are only ever increased,
+ * each by its own thread, so no locks are needed while the buffer is
+ * neither empty nor full. Otherwise the waiting thread spins for a while
+ * and then sleeps until the other one makes progress. If the waiting side
+ * is a fiber, it gets parked instead, so its worker thread can run other
+ * fibers. Fiber can share a buffer with a plain thread.
+ */
+class RingBuffer : public ProvidesOutput {
+  public:
+    explicit RingBuffer(bool usesFibersIn = false)
+        : usesFibers(usesFibersIn) { }
+    void push(int word);
+    int pop();
+    bool isEmpty() const;
+    // Pops next word. If it is the end marker, the stage of the calling
+    // thread gets stopped instead.
+    int getOutput();
+    // Called by consumer that is a fiber. It will get woken up when the
+    // next word gets pushed, even if it parks because of another buffer.
+    void wakeOnPush();
+
+  private:
+    int words[RING_BUFFER_SIZE];
+    // Used by consumer. Each side also keeps the last seen value of the
+    // other side's index, so it doesn't need to read the other thread's
+    // cache line for every word. The two sides are kept on separate cache
+    // lines.
+    atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    char consumerPadding[64];
+    // Used by producer.
+    atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    char producerPadding[64];
+    // Used only by a thread that has to wait.
+    mutex waitMutex;
+    condition_variable progress;
+    atomic<bool> producerWaiting{false};
+    atomic<bool> consumerWaiting{false};
+    bool usesFibers;
+    atomic<Fiber*> producerFiber{NULL};
+    atomic<Fiber*> consumerFiber{NULL};
+    void wakeUp(atomic<bool> &waiting, atomic<Fiber*> &waitingFiber);
+    template<typename Condition>
+    void waitUntil(atomic<bool> &waiting, atomic<Fiber*> &waitingFiber,
+                   Condition condition);
+};
+
+#endif
\ No newline at end of file
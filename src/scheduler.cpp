@@ -0,0 +1,244 @@
+#include "scheduler.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <thread>
+
+#include "const.hpp"
+
+using namespace std;
+
+#if defined(__x86_64__) && defined(__ELF__)
+#define FIBERS_AVAILABLE
+
+extern "C" {
+  // Saves callee-saved registers on the current stack, stores the stack
+  // pointer into 'from', and continues with the stack that 'to' points to.
+  void compSwitchFiber(void **from, void *to);
+  // First function of a new fiber. Passes the fiber, that is in r12, to
+  // the function in r13, which never returns.
+  void compStartFiber();
+}
+
+asm(".text\n"
+    ".globl compSwitchFiber\n"
+    ".type compSwitchFiber, @function\n"
+    "compSwitchFiber:\n"
+    "  pushq %rbp\n"
+    "  pushq %rbx\n"
+    "  pushq %r12\n"
+    "  pushq %r13\n"
+    "  pushq %r14\n"
+    "  pushq %r15\n"
+    "  movq %rsp, (%rdi)\n"
+    "  movq %rsi, %rsp\n"
+    "  popq %r15\n"
+    "  popq %r14\n"
+    "  popq %r13\n"
+    "  popq %r12\n"
+    "  popq %rbx\n"
+    "  popq %rbp\n"
+    "  ret\n"
+    ".globl compStartFiber\n"
+    ".type compStartFiber, @function\n"
+    "compStartFiber:\n"
+    "  movq %r12, %rdi\n"
+    "  callq *%r13\n"
+    "  ud2\n");
+#endif
+
+struct Worker {
+  Scheduler *scheduler;
+  mutex queueMutex;
+  condition_variable fibersReady;
+  deque<Fiber*> queue;
+  // Size of the queue, that can be read without the lock.
+  atomic<size_t> queued{0};
+  Fiber *running = NULL;
+  // Stack pointer of the worker thread, while a fiber is running.
+  void *stackPointer = NULL;
+};
+
+// Worker that is running on this thread.
+static thread_local Worker *currentWorker = NULL;
+
+static void switchContext(void **from, void *to) {
+#ifdef FIBERS_AVAILABLE
+  compSwitchFiber(from, to);
+#endif
+}
+
+Scheduler::Scheduler(size_t workerCount) {
+  for (size_t i = 0; i < workerCount; i++) {
+    workers.push_back(unique_ptr<Worker>(new Worker()));
+    workers.back()->scheduler = this;
+  }
+}
+
+Scheduler::~Scheduler() { }
+
+bool Scheduler::isAvailable() {
+#ifdef FIBERS_AVAILABLE
+  return true;
+#else
+  return false;
+#endif
+}
+
+void Scheduler::spawn(function<void()> body, bool awaited) {
+  Fiber *fiber = new Fiber();
+  fibers.push_back(unique_ptr<Fiber>(fiber));
+  fiber->body = body;
+  fiber->awaited = awaited;
+  fiber->worker = workers[nextWorker].get();
+  nextWorker = (nextWorker + 1) % workers.size();
+  if (awaited) {
+    awaitedLeft++;
+  }
+  // Pages of the stack only get allocated once they are used.
+  void *mem = mmap(NULL, FIBER_STACK_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+  if (mem == MAP_FAILED) {
+    fprintf(stderr, "Error in function Scheduler::spawn, "
+            "could not allocate stack for the fiber.");
+    exit(9);
+  }
+  fiber->stack = (char*) mem;
+  // Lowest page can't be accessed, so that stack overflow crashes the
+  // program instead of overwriting other memory.
+  mprotect(fiber->stack, getpagesize(), PROT_NONE);
+  // Stack looks as if the fiber called 'compSwitchFiber()' from the start
+  // of 'compStartFiber()'.
+  void **sp = (void**) (fiber->stack + FIBER_STACK_SIZE);
+#ifdef FIBERS_AVAILABLE
+  *--sp = (void*) compStartFiber;
+#endif
+  *--sp = NULL;                  // rbp
+  *--sp = NULL;                  // rbx
+  *--sp = (void*) fiber;         // r12
+  *--sp = (void*) runFiber;      // r13
+  *--sp = NULL;                  // r14
+  *--sp = NULL;                  // r15
+  fiber->stackPointer = sp;
+  fiber->worker->queue.push_back(fiber);
+  fiber->worker->queued.store(fiber->worker->queue.size());
+}
+
+void Scheduler::run() {
+  for (unique_ptr<Worker> &worker : workers) {
+    thread(runWorker, worker.get()).detach();
+  }
+  unique_lock<mutex> lock(doneMutex);
+  while (awaitedLeft > 0) {
+    awaitedDone.wait(lock);
+  }
+}
+
+Fiber *Scheduler::getCurrentFiber() {
+  if (currentWorker == NULL) {
+    return NULL;
+  }
+  return currentWorker->running;
+}
+
+void Scheduler::yield() {
+  Fiber *fiber = getCurrentFiber();
+  if (fiber == NULL ||
+      fiber->worker->queued.load(memory_order_relaxed) == 0) {
+    return;
+  }
+  switchToWorker(fiber, FIBER_YIELDED);
+}
+
+void Scheduler::park() {
+  switchToWorker(getCurrentFiber(), FIBER_PARKING);
+}
+
+void Scheduler::wake(Fiber *fiber) {
+  Worker *worker = fiber->worker;
+  lock_guard<mutex> lock(worker->queueMutex);
+  if (fiber->finished) {
+    return;
+  }
+  if (!fiber->parked) {
+    fiber->wakePending = true;
+    return;
+  }
+  fiber->parked = false;
+  worker->queue.push_back(fiber);
+  worker->queued.store(worker->queue.size(), memory_order_relaxed);
+  worker->fibersReady.notify_one();
+}
+
+void Scheduler::exitFiber() {
+  switchToWorker(getCurrentFiber(), FIBER_FINISHED);
+}
+
+/// PRIVATE ///
+
+/*
+ * Runs fibers from the queue one by one, each until it switches back.
+ * Then puts it back in the queue, parks it, or frees its stack.
+ */
+void Scheduler::runWorker(Worker *worker) {
+  currentWorker = worker;
+  while (true) {
+    Fiber *fiber;
+    {
+      unique_lock<mutex> lock(worker->queueMutex);
+      while (worker->queue.empty()) {
+        worker->fibersReady.wait(lock);
+      }
+      fiber = worker->queue.front();
+      worker->queue.pop_front();
+      worker->queued.store(worker->queue.size(), memory_order_relaxed);
+    }
+    fiber->state = FIBER_RUNNING;
+    worker->running = fiber;
+    switchContext(&worker->stackPointer, fiber->stackPointer);
+    worker->running = NULL;
+    unique_lock<mutex> lock(worker->queueMutex);
+    if (fiber->state == FIBER_YIELDED) {
+      worker->queue.push_back(fiber);
+    } else if (fiber->state == FIBER_PARKING) {
+      if (fiber->wakePending) {
+        fiber->wakePending = false;
+        worker->queue.push_back(fiber);
+      } else {
+        fiber->parked = true;
+      }
+    } else if (fiber->state == FIBER_FINISHED) {
+      fiber->finished = true;
+      munmap(fiber->stack, FIBER_STACK_SIZE);
+      fiber->stack = NULL;
+    }
+    worker->queued.store(worker->queue.size(), memory_order_relaxed);
+    lock.unlock();
+    if (fiber->finished) {
+      worker->scheduler->fiberFinished(fiber);
+    }
+  }
+}
+
+void Scheduler::runFiber(Fiber *fiber) {
+  fiber->body();
+  exitFiber();
+}
+
+void Scheduler::switchToWorker(Fiber *fiber, FiberState state) {
+  fiber->state = state;
+  switchContext(&fiber->stackPointer, fiber->worker->stackPointer);
+}
+
+void Scheduler::fiberFinished(Fiber *fiber) {
+  if (!fiber->awaited) {
+    return;
+  }
+  lock_guard<mutex> lock(doneMutex);
+  if (--awaitedLeft == 0) {
+    awaitedDone.notify_all();
+  }
+}
\ No newline at end of file
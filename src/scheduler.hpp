@@ -0,0 +1,89 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+class RingBuffer;
+struct Worker;
+
+// What a fiber asks its worker to do with it, when it switches back.
+enum FiberState { FIBER_RUNNING, FIBER_YIELDED, FIBER_PARKING,
+                  FIBER_FINISHED };
+
+/*
+ * Task with its own stack, that can give up its worker thread in the
+ * middle of a function and later continue where it stopped. It always
+ * runs on the same worker.
+ */
+struct Fiber {
+  function<void()> body;
+  Worker *worker;
+  // Scheduler's 'run()' waits for awaited fibers to finish.
+  bool awaited;
+  FiberState state = FIBER_RUNNING;
+  // Saved while the fiber is not running.
+  void *stackPointer = NULL;
+  char *stack = NULL;
+  // Guarded by the worker's mutex. Wake up that comes while the fiber is
+  // still running makes its next park return immediately.
+  bool parked = false;
+  bool wakePending = false;
+  bool finished = false;
+  // Buffer that the parallel chain stage running in this fiber writes to.
+  RingBuffer *stageOutput = NULL;
+};
+
+/*
+ * Runs many fibers on a few worker threads. Fibers give up the worker
+ * when they have to wait for a ring buffer, or when they run for a while
+ * without waiting, so one worker can multiplex thousands of computers.
+ * Fibers never move between workers. Only available on x86-64, like JIT.
+ */
+class Scheduler {
+  public:
+    explicit Scheduler(size_t workerCount);
+    ~Scheduler();
+    static bool isAvailable();
+    // Fibers get assigned to workers in turns. Must be called before
+    // 'run()'.
+    void spawn(function<void()> body, bool awaited);
+    // Starts the workers and returns when all awaited fibers finish.
+    // Other fibers keep running until the program exits.
+    void run();
+    // Returns NULL when not called from a fiber.
+    static Fiber *getCurrentFiber();
+    // Lets other fibers of the worker run, if there are any. Does nothing
+    // when not called from a fiber.
+    static void yield();
+    // Suspends the calling fiber until somebody wakes it up.
+    static void park();
+    // Can be called from any thread.
+    static void wake(Fiber *fiber);
+    // Ends the calling fiber.
+    static void exitFiber();
+
+  private:
+    vector<unique_ptr<Worker>> workers;
+    // Fibers are kept until the scheduler gets destroyed, so a late wake
+    // up of a finished fiber is harmless.
+    vector<unique_ptr<Fiber>> fibers;
+    size_t nextWorker = 0;
+    mutex doneMutex;
+    condition_variable awaitedDone;
+    size_t awaitedLeft = 0;
+
+    static void runWorker(Worker *worker);
+    static void runFiber(Fiber *fiber);
+    static void switchToWorker(Fiber *fiber, FiberState state);
+    void fiberFinished(Fiber *fiber);
+};
+
+#endif
\ No newline at end of file
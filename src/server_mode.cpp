@@ -0,0 +1,370 @@
+#include "server_mode.hpp"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "batch_mode.hpp"
+#include "const.hpp"
+#include "load.hpp"
+#include "pipe_input.hpp"
+#include "standard_output.hpp"
+
+using namespace std;
+
+// Idle computers by the hash of their program, engine and memoize flag.
+static unordered_map<uint64_t, vector<CachedComputer>> cache;
+static size_t numOfCached = 0;
+static mutex cacheMutex;
+
+static sockaddr_un getAddress(const string &socketPath);
+static void removeStaleSocket(const string &socketPath,
+                              const sockaddr_un &address);
+static uint64_t getKey(const string &program, Engine engine, bool memoize);
+static bool readLine(int fd, string &line);
+static bool readExactly(int fd, char *data, size_t size);
+static bool writeAll(int fd, const char *data, size_t size);
+static void sendInput(int fd);
+static int receiveOutput(int fd);
+
+void ServerMode::serve(string socketPath) {
+  // Client that disconnects early must not end the server.
+  signal(SIGPIPE, SIG_IGN);
+  sockaddr_un address = getAddress(socketPath);
+  removeStaleSocket(socketPath, address);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1 || bind(fd, (sockaddr*) &address, sizeof(address)) == -1 ||
+      listen(fd, SOMAXCONN) == -1) {
+    fprintf(stderr, "Could not listen on socket '%s': %s. Aborting.\n",
+            socketPath.c_str(), strerror(errno));
+    exit(1);
+  }
+  while (true) {
+    int client = accept(fd, NULL, NULL);
+    if (client != -1) {
+      thread(serveClient, client).detach();
+    }
+  }
+}
+
+void ServerMode::sendRequest(string socketPath, vector<string> filenames,
+                             bool outputNumbers, bool outputChars,
+                             bool inputChars, bool binary, Engine engine,
+                             bool memoize) {
+  signal(SIGPIPE, SIG_IGN);
+  sockaddr_un address = getAddress(socketPath);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1 ||
+      connect(fd, (sockaddr*) &address, sizeof(address)) == -1) {
+    fprintf(stderr, "Could not connect to server at '%s': %s. Aborting.\n",
+            socketPath.c_str(), strerror(errno));
+    exit(1);
+  }
+  string request = to_string(outputNumbers) + " " + to_string(outputChars) +
+                   " " + to_string(inputChars) + " " + to_string(binary) +
+                   " " + to_string(engine) + " " + to_string(memoize) + " " +
+                   to_string(filenames.size()) + "\n";
+  for (string filename : filenames) {
+    ifstream file(filename, ios::binary);
+    if (file.fail()) {
+      fprintf(stderr, "Invalid filename '%s'. Aborting.\n",
+              filename.c_str());
+      exit(1);
+    }
+    string program = string(istreambuf_iterator<char>(file),
+                            istreambuf_iterator<char>());
+    request += to_string(program.size()) + " " + filename + "\n" + program;
+  }
+  if (!writeAll(fd, request.data(), request.size())) {
+    fprintf(stderr, "Could not send request to server. Aborting.\n");
+    exit(1);
+  }
+  // Input gets sent from another thread, so that output can be printed
+  // while it is still being sent.
+  thread(sendInput, fd).detach();
+  exit(receiveOutput(fd));
+}
+
+///////////////
+/// PRIVATE ///
+///////////////
+
+void ServerMode::serveClient(int fd) {
+  int status = runRequest(fd);
+  string end = "0\n" + to_string(status) + "\n";
+  writeAll(fd, end.data(), end.size());
+  close(fd);
+}
+
+/*
+ * Reads the header and the programs, and then runs the chain until input
+ * runs out, a program stops, or client disconnects. Returns the status
+ * that the client should exit with.
+ */
+int ServerMode::runRequest(int fd) {
+  string line;
+  int outputNumbers, outputChars, inputChars, binary, engine, memoize;
+  size_t numOfPrograms;
+  // Client that closes the connection without sending anything is another
+  // server checking whether this one still runs.
+  bool gotHeader = readLine(fd, line);
+  if (!gotHeader && line.empty()) {
+    return 1;
+  }
+  bool valid = gotHeader &&
+      sscanf(line.c_str(), "%d %d %d %d %d %d %zu", &outputNumbers,
+             &outputChars, &inputChars, &binary, &engine, &memoize,
+             &numOfPrograms) == 7 &&
+      engine >= INTERPRETER_ENGINE && engine <= TIERED_ENGINE &&
+      numOfPrograms > 0;
+  vector<uint64_t> keys;
+  vector<CachedComputer> chain;
+  for (size_t i = 0; valid && i < numOfPrograms; i++) {
+    size_t size;
+    valid = readLine(fd, line) && sscanf(line.c_str(), "%zu", &size) == 1 &&
+            size <= SERVER_MAX_PROGRAM_SIZE;
+    string program(valid ? size : 0, '\0');
+    valid = valid && readExactly(fd, &program[0], size);
+    if (valid) {
+      string name = line.substr(line.find(' ') + 1);
+      keys.push_back(getKey(program, (Engine) engine, memoize));
+      chain.push_back(takeComputer(keys.back(), program, name,
+                                   (Engine) engine, memoize));
+    }
+  }
+  if (!valid) {
+    fprintf(stderr, "Received invalid request.\n");
+    return 1;
+  }
+  PipeInput input(inputChars, false, binary);
+  StandardOutput output(outputNumbers, outputChars, false);
+  input.readFromDescriptor(fd);
+  output.writeToSocket(fd);
+  input.output = &output;
+  chain[0].computer->ram.input = &input;
+  for (size_t i = 1; i < chain.size(); i++) {
+    chain[i].computer->ram.input = chain[i-1].computer.get();
+  }
+  Computer &last = *chain.back().computer;
+  int status = BatchMode::runJob([&]() {
+    while (!output.failed) {
+      int word = last.getOutput();
+      if (word == NO_OUTPUT) {
+        return;
+      }
+      output.print(word);
+    }
+  }, true);
+  output.finish();
+  // Computers get restarted before the next request, even if they stopped
+  // in the middle of this one.
+  for (size_t i = 0; i < chain.size(); i++) {
+    returnComputer(keys[i], move(chain[i]));
+  }
+  return status;
+}
+
+/*
+ * Returns idle computer with the same program if there is one, otherwise
+ * loads a new one.
+ */
+CachedComputer ServerMode::takeComputer(uint64_t key, const string &program,
+                                        const string &name, Engine engine,
+                                        bool memoize) {
+  CachedComputer cached;
+  {
+    lock_guard<mutex> lock(cacheMutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      cached = move(it->second.back());
+      it->second.pop_back();
+      if (it->second.empty()) {
+        cache.erase(it);
+      }
+      numOfCached--;
+    }
+  }
+  if (cached.computer) {
+    cached.computer->restart(cached.initialState);
+  } else {
+    cached.computer = unique_ptr<Computer>(new Computer());
+    Load::fillRamWithString(program, cached.computer->ram);
+    cached.computer->setEngine(engine);
+    cached.computer->memoize = memoize;
+    cached.initialState = cached.computer->cpu.getState();
+  }
+  cached.computer->name = name;
+  return cached;
+}
+
+/*
+ * Computer gets deleted if cache is full.
+ */
+void ServerMode::returnComputer(uint64_t key, CachedComputer cached) {
+  lock_guard<mutex> lock(cacheMutex);
+  if (numOfCached < SERVER_CACHED_COMPUTERS) {
+    cache[key].push_back(move(cached));
+    numOfCached++;
+  }
+}
+
+static sockaddr_un getAddress(const string &socketPath) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Socket path '%s' is too long. Aborting.\n",
+            socketPath.c_str());
+    exit(1);
+  }
+  strcpy(address.sun_path, socketPath.c_str());
+  return address;
+}
+
+/*
+ * Socket file left by a previous server would make bind fail. Anything
+ * else at the path, including the socket of a server that still runs, is
+ * left alone, and server doesn't start.
+ */
+static void removeStaleSocket(const string &socketPath,
+                              const sockaddr_un &address) {
+  struct stat info;
+  if (lstat(socketPath.c_str(), &info) == -1) {
+    return;
+  }
+  if (!S_ISSOCK(info.st_mode)) {
+    fprintf(stderr, "File '%s' exists and is not a socket. Aborting.\n",
+            socketPath.c_str());
+    exit(1);
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  bool answered = fd != -1 &&
+      connect(fd, (sockaddr*) &address, sizeof(address)) == 0;
+  if (fd != -1) {
+    close(fd);
+  }
+  if (answered) {
+    fprintf(stderr, "Another server is listening on '%s'. Aborting.\n",
+            socketPath.c_str());
+    exit(1);
+  }
+  unlink(socketPath.c_str());
+}
+
+/*
+ * FNV-1a hash of the program and the options that change how it runs.
+ */
+static uint64_t getKey(const string &program, Engine engine, bool memoize) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : program + (char) engine + (char) memoize) {
+    hash = (hash ^ (uint8_t) c) * 1099511628211ull;
+  }
+  return hash;
+}
+
+/*
+ * Reads one byte at a time, so that nothing after the line gets consumed.
+ */
+static bool readLine(int fd, string &line) {
+  line.clear();
+  char c;
+  while (line.size() < SERVER_MAX_LINE) {
+    if (!readExactly(fd, &c, 1)) {
+      return false;
+    }
+    if (c == '\n') {
+      return true;
+    }
+    line += c;
+  }
+  return false;
+}
+
+static bool readExactly(int fd, char *data, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t num = read(fd, data + done, size - done);
+    if (num == -1 && errno == EINTR) {
+      continue;
+    }
+    if (num <= 0) {
+      return false;
+    }
+    done += num;
+  }
+  return true;
+}
+
+static bool writeAll(int fd, const char *data, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t num = write(fd, data + done, size - done);
+    if (num == -1 && errno == EINTR) {
+      continue;
+    }
+    if (num == -1) {
+      return false;
+    }
+    done += num;
+  }
+  return true;
+}
+
+/*
+ * Copies stdin to the socket, and then tells the server that input ended.
+ */
+static void sendInput(int fd) {
+  vector<char> buffer(INPUT_BUFFER_SIZE);
+  while (true) {
+    ssize_t num = read(0, buffer.data(), buffer.size());
+    if (num == -1 && errno == EINTR) {
+      continue;
+    }
+    if (num <= 0 || !writeAll(fd, buffer.data(), num)) {
+      break;
+    }
+  }
+  shutdown(fd, SHUT_WR);
+}
+
+/*
+ * Prints frames of output as they arrive and returns the status that
+ * follows them.
+ */
+static int receiveOutput(int fd) {
+  FILE *in = fdopen(fd, "r");
+  vector<char> buffer;
+  while (true) {
+    size_t size;
+    if (fscanf(in, "%zu", &size) != 1 || fgetc(in) != '\n') {
+      fprintf(stderr, "Server closed the connection. Aborting.\n");
+      return 1;
+    }
+    if (size == 0) {
+      break;
+    }
+    buffer.resize(size);
+    if (fread(buffer.data(), 1, size, in) != size) {
+      fprintf(stderr, "Server closed the connection. Aborting.\n");
+      return 1;
+    }
+    fwrite(buffer.data(), 1, size, stdout);
+    fflush(stdout);
+  }
+  int status;
+  if (fscanf(in, "%d", &status) != 1) {
+    return 1;
+  }
+  return status;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef SERVER_MODE_H
+#define SERVER_MODE_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "computer.hpp"
+#include "engine.hpp"
+#include "machine_state.hpp"
+
+using namespace std;
+
+/*
+ * Loaded computer that waits for the next request with the same program.
+ * Keeps everything that gets derived from the program while it runs, like
+ * the byte filter table, JIT code and transition cache.
+ */
+struct CachedComputer {
+  unique_ptr<Computer> computer;
+  MachineState initialState;
+};
+
+/*
+ * Long running process that listens on a Unix domain socket and runs a
+ * chain of computers for every client that connects, so requests don't pay
+ * for process startup and loading of programs. Computers get cached by the
+ * hash of their program, engine and memoize flag, and get restarted
+ * when they are reused.
+ *
+ * Request is a header line 'outputNumbers outputChars inputChars binary
+ * engine memoize numOfPrograms', followed by every program as a line 'size
+ * name' and 'size' bytes of its file, and then by the input, until client
+ * shuts down its side of the connection. Response is the output, sent in
+ * frames that each start with a line holding their length, followed by
+ * an empty frame and a line with the exit status.
+ */
+class ServerMode {
+  public:
+    // Never returns.
+    static void serve(string socketPath);
+    // Sends files and stdin to the server and prints its output. Exits with
+    // the status that server returns.
+    static void sendRequest(string socketPath, vector<string> filenames,
+                            bool outputNumbers, bool outputChars,
+                            bool inputChars, bool binary, Engine engine,
+                            bool memoize);
+
+  private:
+    static void serveClient(int fd);
+    static int runRequest(int fd);
+    static CachedComputer takeComputer(uint64_t key, const string &program,
+                                       const string &name, Engine engine,
+                                       bool memoize);
+    static void returnComputer(uint64_t key, CachedComputer cached);
+};
+
+#endif
\ No newline at end of file
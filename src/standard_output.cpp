@@ -1,31 +1,164 @@
 #include "standard_output.hpp"
 
-#include <iostream>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 
+#include "const.hpp"
 #include "util.hpp"
 
 using namespace std;
 
+// Output that gets flushed when program exits.
+static StandardOutput *runningOutput = NULL;
+
+static void flushRunningOutput() {
+  if (runningOutput != NULL) {
+    runningOutput->finish();
+  }
+}
+
+StandardOutput::StandardOutput(bool outputNumbers, bool outputChars,
+                               bool rawMode)
+    : flushEagerly(rawMode || !Util::outputIsPiped()),
+      formattedWords(vector<string>(MAX_VALUE+1)),
+      buffer(vector<char>(OUTPUT_BUFFER_SIZE)) {
+  for (int i = 0; i <= MAX_VALUE; i++) {
+    vector<bool> word = Util::getBoolByte(i);
+    if (outputChars) {
+      formattedWords[i] = string(1, (char) i);
+    } else if (outputNumbers) {
+      formattedWords[i] = Util::getStringWithFormatedInt(word);
+    } else {
+      formattedWords[i] = Util::getString(word) + "\n";
+    }
+  }
+}
+
 void StandardOutput::run() {
+  finishAtExit();
   while (1) {
-    vector<bool> out = input->getOutput();
-    if (out.empty()) {
+    int out = input->getOutput();
+    if (out == NO_OUTPUT) {
+      finish();
       return;
     } else {
-      printBool(out);
+      print(out);
+    }
+  }
+}
+
+void StandardOutput::print(uint8_t wordIn) {
+  const string &word = formattedWords[wordIn];
+  if (length + word.size() > buffer.size()) {
+    flush();
+  }
+  memcpy(buffer.data() + length, word.data(), word.size());
+  length += word.size();
+  // Captured output is not seen by anybody until the job ends.
+  if (flushEagerly && capture == NULL) {
+    flush();
+  }
+}
+
+/*
+ * Computers and pipe input end the program by calling exit(), so the
+ * buffered output gets written out by the exit handler.
+ */
+void StandardOutput::finishAtExit() {
+  runningOutput = this;
+  atexit(flushRunningOutput);
+}
+
+/*
+ * Writes out the contents of the buffer with as few system calls as
+ * possible.
+ */
+void StandardOutput::flush() {
+  if (capture != NULL) {
+    capture->append(buffer.data(), length);
+    length = 0;
+    return;
+  }
+  if (file) {
+    file->write(buffer.data(), length);
+    length = 0;
+    return;
+  }
+  if (socket != -1) {
+    writeFrame();
+    length = 0;
+    return;
+  }
+  if (!writeAll(1, buffer.data(), length)) {
+    failed = true;
+  }
+  length = 0;
+}
+
+void StandardOutput::finish() {
+  if (newlineAtEnd) {
+    newlineAtEnd = false;
+    if (length == buffer.size()) {
+      flush();
     }
+    buffer[length++] = '\n';
+  }
+  flush();
+  if (file) {
+    file->truncate();
   }
 }
 
-void StandardOutput::printBool(vector<bool> wordIn) {
-  if (outputChars) {
-    cout << (char)Util::getInt(wordIn);
-    fflush(stdout);
-  } else if (outputNumbers) {
-    cout << Util::getStringWithFormatedInt(wordIn);
-  } else {
-    cout << Util::getString(wordIn) + "\n";
+/*
+ * Output will be written to the mapped file instead of stdout.
+ */
+void StandardOutput::writeToFile(const string &filename) {
+  file = make_shared<MappedOutputFile>(filename);
+  flushEagerly = false;
+}
+
+/*
+ * Output will be sent to the socket in frames, so the client can tell it
+ * apart from the status that server sends after it.
+ */
+void StandardOutput::writeToSocket(int fd) {
+  socket = fd;
+  flushEagerly = false;
+}
+
+/// PRIVATE ///
+
+void StandardOutput::writeFrame() {
+  if (length == 0 || failed) {
+    return;
+  }
+  char header[32];
+  int headerLength = snprintf(header, sizeof(header), "%zu\n", length);
+  if (!writeAll(socket, header, headerLength) ||
+      !writeAll(socket, buffer.data(), length)) {
+    failed = true;
   }
 }
 
+/*
+ * Writes out the data with as few system calls as possible. Returns false
+ * if the descriptor can't be written to anymore.
+ */
+bool StandardOutput::writeAll(int fd, const char *data, size_t size) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t num = write(fd, data + written, size - written);
+    if (num == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    written += num;
+  }
+  return true;
+}
\ No newline at end of file
@@ -1,25 +1,53 @@
 #ifndef STANDARD_OUTPUT_H
 #define STANDARD_OUTPUT_H
 
+#include <stdint.h>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "mapped_file.hpp"
+
 #include "provides_output.hpp"
 
 using namespace std;
 
 class StandardOutput {
   public:
-    StandardOutput(bool outputNumbersIn, bool outputCharsIn) 
-        : outputNumbers(outputNumbersIn), outputChars(outputCharsIn) { }
+    StandardOutput(bool outputNumbers, bool outputChars, bool rawMode);
     void run();
+    void print(uint8_t wordIn);
+    void flush();
+    void finish();
+    void finishAtExit();
+    void writeToFile(const string &filename);
+    void writeToSocket(int fd);
 
     ProvidesOutput *input = NULL;
+    // Set in char mode when stdin runs out.
+    bool newlineAtEnd = false;
+    // If set, output gets appended to it instead of written to stdout.
+    string *capture = NULL;
+    // Set if output couldn't be written, because the reader is gone.
+    bool failed = false;
     
   private:
-    const bool outputNumbers;
-    const bool outputChars;
-    void printBool(vector<bool> wordIn);
+    // Output gets written after every word if it goes to a terminal or if
+    // the game mode is on. Otherwise only when buffer is full, when chain
+    // waits for input, or when it stops.
+    bool flushEagerly;
+    // How each of the 256 words gets printed.
+    vector<string> formattedWords;
+    vector<char> buffer;
+    size_t length = 0;
+    // Used instead of stdout if set.
+    shared_ptr<MappedOutputFile> file;
+    // Used instead of stdout if set. Every flush gets written as a frame,
+    // that starts with its length and a new line.
+    int socket = -1;
+
+    void writeFrame();
+    bool writeAll(int fd, const char *data, size_t size);
 };
 
 #endif
\ No newline at end of file
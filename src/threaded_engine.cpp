@@ -0,0 +1,209 @@
+#include "threaded_engine.hpp"
+
+#include <algorithm>
+
+#include "address.hpp"
+#include "const.hpp"
+#include "isa.hpp"
+#include "ram.hpp"
+
+using namespace std;
+
+// Handlers are specified by opcode, with an additional one that stops the
+// execution.
+const int STOP_HANDLER = NUM_OF_OPCODES;
+
+static inline uint8_t loadWord(uint8_t adr, uint8_t *data, Ram &ram);
+
+/////////////////
+/// INTERFACE ///
+/////////////////
+
+/*
+ * Decodes code address space into handler ids and operands. Needs to be
+ * called whenever the code changes.
+ */
+void ThreadedEngine::load(const Ram &ram) {
+  for (int i = 0; i < RAM_SIZE; i++) {
+    uint8_t word = ram.state[CODE][i];
+    Opcode opcode = Isa::decode(word);
+    handlerIds[i] = opcode;
+    operands[i] = Isa::getFirstOrderAdr(opcode, word).val;
+  }
+  handlerIds[RAM_SIZE] = STOP_HANDLER;
+  operands[RAM_SIZE] = 0;
+  linked = false;
+}
+
+/*
+ * Runs the program until it sends a word to the output, reaches the last
+ * address, or is about to execute more jumps than the budget allows.
+ * Behaves the same as calling Cpu::step in a loop.
+ */
+RunResult ThreadedEngine::run(uint8_t &pcInOut, uint8_t &regInOut, Ram &ram,
+                              long budget) {
+  // In the same order as opcodes.
+  static const void * const LABELS[] = {
+    &&read, &&write, &&add, &&sub, &&jump, &&ifMax, &&ifMin, &&jumpReg,
+    &&readReg, &&init, &&not_, &&shiftLeft, &&shiftRight, &&and_, &&or_,
+    &&xor_, &&readPointer, &&writePointer, &&inc, &&dec, &&print,
+    &&ifNotMax, &&ifNotMin, &&stop
+  };
+  static_assert(sizeof(LABELS) / sizeof(LABELS[0]) == NUM_OF_OPCODES + 1,
+                "Threaded engine is missing a handler.");
+  if (!linked) {
+    for (int i = 0; i <= RAM_SIZE; i++) {
+      handlers[i] = LABELS[handlerIds[i]];
+    }
+    linked = true;
+  }
+
+  uint8_t pc = pcInOut;
+  uint8_t reg = regInOut;
+  uint8_t *data = ram.state[DATA].data();
+  uint8_t a;
+
+// Operand of the instruction at pc.
+#define OPERAND operands[pc]
+#define LOAD(ADR) loadWord(ADR, data, ram)
+#define DISPATCH() goto *handlers[pc]
+// Placed before every jump, so it doesn't get executed if budget is spent.
+#define SPEND_BUDGET() if (budget-- == 0) goto budgetSpent
+#define NEXT() pc++; DISPATCH()
+// Stores word to the address, or sends it to the output and returns if
+// address is the last one.
+#define STORE_AND_NEXT(ADR, WORD) \
+    if ((ADR) == LAST_ADDRESS) { \
+      ram.set(Address(DATA, LAST_ADDRESS), WORD); \
+      pc++; \
+      goto output; \
+    } \
+    data[ADR] = WORD; \
+    NEXT()
+
+  DISPATCH();
+
+  read:
+    reg = LOAD(OPERAND);
+    NEXT();
+  write:
+    a = OPERAND;
+    STORE_AND_NEXT(a, reg);
+  add:
+    reg = min(reg + LOAD(OPERAND), MAX_VALUE);
+    NEXT();
+  sub:
+    reg = max(reg - LOAD(OPERAND), 0);
+    NEXT();
+  jump:
+    SPEND_BUDGET();
+    pc = OPERAND;
+    DISPATCH();
+  ifMax:
+    SPEND_BUDGET();
+    if (reg == MAX_VALUE) {
+      pc = OPERAND;
+      DISPATCH();
+    }
+    NEXT();
+  ifMin:
+    SPEND_BUDGET();
+    if (reg == 0) {
+      pc = OPERAND;
+      DISPATCH();
+    }
+    NEXT();
+  jumpReg:
+    SPEND_BUDGET();
+    pc = reg & 0x0f;
+    DISPATCH();
+  readReg:
+    reg = LOAD(reg & 0x0f);
+    NEXT();
+  init:
+    reg = data[INIT_OPERAND_INDEX];
+    data[OPERAND] = reg;
+    NEXT();
+  not_:
+    reg = ~reg;
+    NEXT();
+  shiftLeft:
+    reg <<= 1;
+    NEXT();
+  shiftRight:
+    reg >>= 1;
+    NEXT();
+  and_:
+    reg &= data[OPERAND];
+    NEXT();
+  or_:
+    reg |= data[OPERAND];
+    NEXT();
+  xor_:
+    reg ^= data[OPERAND];
+    NEXT();
+  readPointer:
+    a = LOAD(OPERAND) & 0x0f;
+    reg = LOAD(a);
+    NEXT();
+  writePointer:
+    a = LOAD(OPERAND) & 0x0f;
+    STORE_AND_NEXT(a, reg);
+  inc:
+    reg = ++data[OPERAND];
+    NEXT();
+  dec:
+    reg = --data[OPERAND];
+    NEXT();
+  print:
+    ram.set(Address(DATA, LAST_ADDRESS), LOAD(OPERAND));
+    pc++;
+    goto output;
+  ifNotMax:
+    SPEND_BUDGET();
+    if (reg != MAX_VALUE) {
+      pc = OPERAND;
+      DISPATCH();
+    }
+    NEXT();
+  ifNotMin:
+    SPEND_BUDGET();
+    if (reg != 0) {
+      pc = OPERAND;
+      DISPATCH();
+    }
+    NEXT();
+  stop:
+    pcInOut = pc;
+    regInOut = reg;
+    return RUN_STOPPED;
+  output:
+    pcInOut = pc;
+    regInOut = reg;
+    return RUN_OUTPUT;
+  budgetSpent:
+    pcInOut = pc;
+    regInOut = reg;
+    return RUN_BUDGET_SPENT;
+
+#undef OPERAND
+#undef LOAD
+#undef DISPATCH
+#undef SPEND_BUDGET
+#undef NEXT
+#undef STORE_AND_NEXT
+}
+
+//////////
+// UTIL //
+//////////
+
+/*
+ * Reading from the last address consumes input.
+ */
+uint8_t loadWord(uint8_t adr, uint8_t *data, Ram &ram) {
+  if (adr == LAST_ADDRESS) {
+    return ram.get(Address(DATA, LAST_ADDRESS));
+  }
+  return data[adr];
+}
@@ -0,0 +1,34 @@
+#ifndef THREADED_ENGINE_H
+#define THREADED_ENGINE_H
+
+#include <array>
+#include <stdint.h>
+
+#include "const.hpp"
+#include "engine.hpp"
+
+using namespace std;
+
+class Ram;
+
+/*
+ * Executes the program as direct threaded code. Every code address gets
+ * the address of its handler, so each handler jumps straight to the next
+ * one, using GCC's computed goto (labels as values).
+ */
+class ThreadedEngine {
+  public:
+    void load(const Ram &ram);
+    RunResult run(uint8_t &pc, uint8_t &reg, Ram &ram, long budget);
+
+  private:
+    // Index of handler and operand for each code address. The extra last
+    // element stands for the last address, where execution stops.
+    array<uint8_t, RAM_SIZE+1> handlerIds;
+    array<uint8_t, RAM_SIZE+1> operands;
+    // Handler ids get translated into label addresses on first run.
+    array<const void*, RAM_SIZE+1> handlers;
+    bool linked = false;
+};
+
+#endif
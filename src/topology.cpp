@@ -0,0 +1,505 @@
+#include "topology.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "const.hpp"
+#include "load.hpp"
+#include "parallel_chain.hpp"
+#include "scheduler.hpp"
+#include "util.hpp"
+
+using namespace std;
+
+const map<string, NodeKind> NODE_KINDS = {
+  { "input", INPUT_NODE },
+  { "output", OUTPUT_NODE },
+  { "computer", COMPUTER_NODE },
+  { "broadcast", BROADCAST_NODE },
+  { "round-robin", ROUND_ROBIN_NODE },
+  { "merge", MERGE_NODE },
+  { "interleave", INTERLEAVE_NODE }
+};
+
+/*
+ * Sends every word to all outputs.
+ */
+static void broadcast(RingBuffer *input, vector<RingBuffer*> outputs) {
+  while (true) {
+    int word = input->pop();
+    for (RingBuffer *output : outputs) {
+      output->push(word);
+    }
+    if (word < 0) {
+      return;
+    }
+  }
+}
+
+/*
+ * Sends each word to the next output, going around in circle. End marker
+ * gets sent to all of them.
+ */
+static void dealInTurns(RingBuffer *input, vector<RingBuffer*> outputs) {
+  for (size_t i = 0; true; i = (i + 1) % outputs.size()) {
+    int word = input->pop();
+    if (word < 0) {
+      for (RingBuffer *output : outputs) {
+        output->push(word);
+      }
+      return;
+    }
+    outputs[i]->push(word);
+  }
+}
+
+/*
+ * Output of the fan-in node ends when all of its inputs end. It ends with
+ * the error if any of them got stuck, otherwise with a new line if any of
+ * them did.
+ */
+static int getJoinedMarker(int marker, int word) {
+  if (marker <= STUCK_IN_LOOP) {
+    return marker;
+  }
+  if (word <= STUCK_IN_LOOP || word == END_OF_INPUT) {
+    return word;
+  }
+  return marker;
+}
+
+/*
+ * Takes one word from each input in turn, skipping the ones that ended.
+ * Restores the order of words that were dealt by round-robin node, as
+ * long as every branch returns one word for every word it gets.
+ */
+static void interleave(vector<RingBuffer*> inputs, RingBuffer *output) {
+  vector<bool> ended(inputs.size(), false);
+  size_t running = inputs.size();
+  int marker = NO_OUTPUT;
+  for (size_t i = 0; running > 0; i = (i + 1) % inputs.size()) {
+    if (ended[i]) {
+      continue;
+    }
+    int word = inputs[i]->pop();
+    if (word < 0) {
+      ended[i] = true;
+      running--;
+      marker = getJoinedMarker(marker, word);
+      continue;
+    }
+    output->push(word);
+  }
+  output->push(marker);
+}
+
+/*
+ * Parks the fiber until a word gets pushed to one of the inputs that
+ * didn't end yet.
+ */
+static void waitForAnyInput(vector<RingBuffer*> &inputs,
+                            vector<bool> &ended) {
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!ended[i]) {
+      inputs[i]->wakeOnPush();
+    }
+  }
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!ended[i] && !inputs[i]->isEmpty()) {
+      return;
+    }
+  }
+  Scheduler::park();
+}
+
+/*
+ * Passes on words in the order they arrive. When all inputs are empty it
+ * spins for a while and then starts sleeping between the checks, like a
+ * ring buffer does. Fiber gets parked instead.
+ */
+static void merge(vector<RingBuffer*> inputs, RingBuffer *output) {
+  vector<bool> ended(inputs.size(), false);
+  size_t running = inputs.size();
+  int marker = NO_OUTPUT;
+  int idleChecks = 0;
+  while (running > 0) {
+    bool gotWord = false;
+    for (size_t i = 0; i < inputs.size(); i++) {
+      if (ended[i] || inputs[i]->isEmpty()) {
+        continue;
+      }
+      gotWord = true;
+      int word = inputs[i]->pop();
+      if (word < 0) {
+        ended[i] = true;
+        running--;
+        marker = getJoinedMarker(marker, word);
+      } else {
+        output->push(word);
+      }
+    }
+    if (gotWord) {
+      idleChecks = 0;
+    } else if (Scheduler::getCurrentFiber() != NULL) {
+      waitForAnyInput(inputs, ended);
+    } else if (++idleChecks < RING_SPIN_COUNT) {
+      this_thread::yield();
+    } else {
+      this_thread::sleep_for(chrono::microseconds(RING_SLEEP_MICROSECONDS));
+    }
+  }
+  output->push(marker);
+}
+
+Topology::Topology(string filenameIn, bool outputNumbers, bool outputChars,
+                   bool inputChars, bool rawInput, bool binary,
+                   Engine engine, bool memoize, size_t fiberWorkersIn)
+    : filename(filenameIn),
+      fiberWorkers(Scheduler::isAvailable() ? fiberWorkersIn : 0) {
+  ifstream file(filename);
+  if (file.fail()) {
+    cout << "Could not open file " << filename << "." << endl;
+    exit(1);
+  }
+  string line;
+  while (getline(file, line)) {
+    lineNumber++;
+    parseLine(line);
+  }
+  checkNodes();
+  checkForCycles();
+  build(outputNumbers, outputChars, inputChars, rawInput, binary, engine,
+        memoize);
+}
+
+/*
+ * Starts a thread or a fiber for every node. Program ends when all
+ * outputs end.
+ */
+void Topology::run() {
+  Scheduler scheduler(fiberWorkers);
+  vector<thread> outputThreads;
+  for (TopologyNode &node : nodes) {
+    function<void()> task = getTask(node);
+    if (!task) {
+      continue;
+    }
+    bool isOutput = node.kind == OUTPUT_NODE;
+    // Blocking read would stop all fibers of the worker, so input always
+    // gets read on its own thread.
+    if (fiberWorkers > 0 && node.kind != INPUT_NODE) {
+      scheduler.spawn(task, isOutput);
+    } else if (isOutput) {
+      outputThreads.push_back(thread(task));
+    } else {
+      thread(task).detach();
+    }
+  }
+  if (fiberWorkers > 0) {
+    scheduler.run();
+  }
+  for (thread &outputThread : outputThreads) {
+    outputThread.join();
+  }
+  // Other threads are either sleeping or still waiting for input.
+  exit(0);
+}
+
+/// PRIVATE ///
+
+/*
+ * Returns function that runs the node, or nothing if the input node gets
+ * read directly by a computer.
+ */
+function<void()> Topology::getTask(TopologyNode &node) {
+  vector<RingBuffer*> inputs;
+  for (size_t edge : node.inEdges) {
+    inputs.push_back(edges[edge].buffer.get());
+  }
+  vector<RingBuffer*> outputs;
+  for (size_t edge : node.outEdges) {
+    outputs.push_back(edges[edge].buffer.get());
+  }
+  switch (node.kind) {
+    case INPUT_NODE:
+      if (outputs[0] == NULL) {
+        return function<void()>();
+      }
+      return bind(ParallelChain::runStage, node.input.get(), outputs[0]);
+    case OUTPUT_NODE:
+      return bind(ParallelChain::printAll, ref(*inputs[0]),
+                  ref(*node.output));
+    case COMPUTER_NODE:
+      return bind(ParallelChain::runStage, node.computer.get(), outputs[0]);
+    case BROADCAST_NODE:
+      return bind(broadcast, inputs[0], outputs);
+    case ROUND_ROBIN_NODE:
+      return bind(dealInTurns, inputs[0], outputs);
+    case MERGE_NODE:
+      return bind(merge, inputs, outputs[0]);
+    case INTERLEAVE_NODE:
+      return bind(interleave, inputs, outputs[0]);
+  }
+  return function<void()>();
+}
+
+/*
+ * Line is either a declaration of a node: '<type> <name> [<file>]', or a
+ * connection: '<name> > <name> [> <name>...]'.
+ */
+void Topology::parseLine(const string &lineIn) {
+  string line = lineIn.substr(0, lineIn.find('#'));
+  if (line.find('>') != string::npos) {
+    connectNodes(line);
+    return;
+  }
+  istringstream stream(line);
+  vector<string> tokens;
+  string token;
+  while (stream >> token) {
+    tokens.push_back(token);
+  }
+  if (!tokens.empty()) {
+    declareNode(tokens);
+  }
+}
+
+void Topology::declareNode(const vector<string> &tokens) {
+  auto kind = NODE_KINDS.find(tokens[0]);
+  if (kind == NODE_KINDS.end()) {
+    fail(lineNumber, "Unknown node type '" + tokens[0] + "'");
+  }
+  if (tokens.size() < 2) {
+    fail(lineNumber, "Missing name of the " + tokens[0] + " node");
+  }
+  string name = tokens[1];
+  bool usesFile = kind->second == INPUT_NODE ||
+                  kind->second == OUTPUT_NODE ||
+                  kind->second == COMPUTER_NODE;
+  size_t maxTokens = usesFile ? 3 : 2;
+  if (tokens.size() > maxTokens) {
+    fail(lineNumber, "Unexpected '" + tokens[maxTokens] + "'");
+  }
+  if (kind->second == COMPUTER_NODE && tokens.size() < 3) {
+    fail(lineNumber, "Missing program of computer '" + name + "'");
+  }
+  if (nodeIndices.count(name) > 0) {
+    fail(lineNumber, "Node '" + name + "' is already declared");
+  }
+  TopologyNode node;
+  node.kind = kind->second;
+  node.name = name;
+  if (tokens.size() == 3) {
+    node.filename = getPath(tokens[2]);
+  }
+  node.line = lineNumber;
+  nodeIndices[name] = nodes.size();
+  nodes.push_back(move(node));
+}
+
+void Topology::connectNodes(const string &line) {
+  vector<size_t> path;
+  istringstream stream(line);
+  string part;
+  while (getline(stream, part, '>')) {
+    istringstream partStream(part);
+    string name, rest;
+    if (!(partStream >> name) || partStream >> rest) {
+      fail(lineNumber, "Expected one node name between '>' signs");
+    }
+    path.push_back(getNodeIndex(name));
+  }
+  // Line that ends with '>' doesn't produce an empty part.
+  if (line.find_last_not_of(" \t\r") == line.rfind('>')) {
+    fail(lineNumber, "Expected one node name between '>' signs");
+  }
+  for (size_t i = 1; i < path.size(); i++) {
+    TopologyEdge edge;
+    edge.from = path[i-1];
+    edge.to = path[i];
+    nodes[edge.from].outEdges.push_back(edges.size());
+    nodes[edge.to].inEdges.push_back(edges.size());
+    edges.push_back(move(edge));
+  }
+}
+
+size_t Topology::getNodeIndex(const string &name) {
+  auto index = nodeIndices.find(name);
+  if (index == nodeIndices.end()) {
+    fail(lineNumber, "Unknown node '" + name + "'");
+  }
+  return index->second;
+}
+
+void Topology::checkNodes() {
+  bool hasOutput = false;
+  int stdinNodes = 0;
+  int stdoutNodes = 0;
+  for (const TopologyNode &node : nodes) {
+    switch (node.kind) {
+      case INPUT_NODE:
+        checkDegree(node, 0, 0, 1, 1);
+        if (node.filename.empty() && ++stdinNodes > 1) {
+          fail(node.line, "Only one input can read from stdin");
+        }
+        break;
+      case OUTPUT_NODE:
+        checkDegree(node, 1, 1, 0, 0);
+        hasOutput = true;
+        if (node.filename.empty() && ++stdoutNodes > 1) {
+          fail(node.line, "Only one output can write to stdout");
+        }
+        break;
+      case COMPUTER_NODE:
+        checkDegree(node, 1, 1, 1, 1);
+        if (!Util::fileExists(node.filename)) {
+          fail(node.line, "Could not open file " + node.filename);
+        }
+        break;
+      case BROADCAST_NODE:
+      case ROUND_ROBIN_NODE:
+        checkDegree(node, 1, 1, 1, edges.size());
+        break;
+      case MERGE_NODE:
+      case INTERLEAVE_NODE:
+        checkDegree(node, 1, edges.size(), 1, 1);
+        break;
+    }
+  }
+  if (!hasOutput) {
+    fail(lineNumber, "There is no output node");
+  }
+}
+
+void Topology::checkDegree(const TopologyNode &node, size_t minIn,
+                           size_t maxIn, size_t minOut, size_t maxOut) {
+  string name = "'" + node.name + "'";
+  if (node.inEdges.size() < minIn) {
+    fail(node.line, "Nothing is connected to " + name);
+  }
+  if (node.inEdges.size() > maxIn) {
+    if (maxIn == 0) {
+      fail(node.line, "Nothing can be connected to input " + name);
+    }
+    fail(node.line, "Only one node can be connected to " + name +
+                    ", use merge or interleave to join them");
+  }
+  if (node.outEdges.size() < minOut) {
+    fail(node.line, name + " is not connected to anything");
+  }
+  if (node.outEdges.size() > maxOut) {
+    if (maxOut == 0) {
+      fail(node.line, "Output " + name + " can't be connected to anything");
+    }
+    fail(node.line, name + " can only be connected to one node, use " +
+                    "broadcast or round-robin to split its output");
+  }
+}
+
+/*
+ * Removes nodes whose inputs were all removed already, until there are
+ * none left. If some nodes remain, they are on a cycle or after it.
+ */
+void Topology::checkForCycles() {
+  vector<size_t> inputsLeft;
+  vector<size_t> ready;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    inputsLeft.push_back(nodes[i].inEdges.size());
+    if (inputsLeft[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  size_t removed = 0;
+  while (!ready.empty()) {
+    size_t index = ready.back();
+    ready.pop_back();
+    removed++;
+    for (size_t edge : nodes[index].outEdges) {
+      if (--inputsLeft[edges[edge].to] == 0) {
+        ready.push_back(edges[edge].to);
+      }
+    }
+  }
+  if (removed == nodes.size()) {
+    return;
+  }
+  // Every remaining node gets words from another remaining node, so
+  // going backwards long enough ends up on the cycle.
+  size_t index = 0;
+  while (inputsLeft[index] == 0) {
+    index++;
+  }
+  for (size_t i = 0; i < nodes.size(); i++) {
+    for (size_t edge : nodes[index].inEdges) {
+      if (inputsLeft[edges[edge].from] > 0) {
+        index = edges[edge].from;
+        break;
+      }
+    }
+  }
+  fail(nodes[index].line, "'" + nodes[index].name + "' is part of a cycle");
+}
+
+void Topology::build(bool outputNumbers, bool outputChars, bool inputChars,
+                     bool rawInput, bool binary, Engine engine,
+                     bool memoize) {
+  for (TopologyNode &node : nodes) {
+    bool usesStd = node.filename.empty();
+    if (node.kind == INPUT_NODE) {
+      node.input.reset(new PipeInput(inputChars, rawInput && usesStd,
+                                     binary));
+      if (!usesStd) {
+        node.input->readFromFile(node.filename);
+      }
+    } else if (node.kind == OUTPUT_NODE) {
+      node.output.reset(new StandardOutput(outputNumbers && usesStd,
+                                           outputChars, rawInput && usesStd));
+      if (!usesStd) {
+        node.output->writeToFile(node.filename);
+      }
+    } else if (node.kind == COMPUTER_NODE) {
+      node.computer.reset(new Computer());
+      Load::fillRamWithFile(node.filename.c_str(), node.computer->ram);
+      node.computer->setEngine(engine);
+      node.computer->name = node.filename;
+      node.computer->memoize = memoize;
+    }
+  }
+  // Computer reads the input node directly, instead of through a buffer
+  // and another thread. Not with fibers, where input has its own thread.
+  for (TopologyEdge &edge : edges) {
+    TopologyNode &from = nodes[edge.from];
+    TopologyNode &to = nodes[edge.to];
+    if (from.kind == INPUT_NODE && to.kind == COMPUTER_NODE &&
+        fiberWorkers == 0) {
+      to.computer->ram.input = from.input.get();
+      continue;
+    }
+    edge.buffer.reset(new RingBuffer(fiberWorkers > 0));
+    if (to.kind == COMPUTER_NODE) {
+      to.computer->ram.input = edge.buffer.get();
+    }
+  }
+}
+
+/*
+ * Files are relative to the directory of the topology file.
+ */
+string Topology::getPath(const string &name) {
+  size_t slashIndex = filename.find_last_of('/');
+  if (name[0] == '/' || slashIndex == string::npos) {
+    return name;
+  }
+  return filename.substr(0, slashIndex + 1) + name;
+}
+
+void Topology::fail(int line, const string &message) {
+  cout << filename << ":" << line << ": " << message << ". Aborting."
+       << endl;
+  exit(1);
+}
\ No newline at end of file
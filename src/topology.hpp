@@ -0,0 +1,84 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "computer.hpp"
+#include "engine.hpp"
+#include "pipe_input.hpp"
+#include "ring_buffer.hpp"
+#include "standard_output.hpp"
+
+using namespace std;
+
+enum NodeKind { INPUT_NODE, OUTPUT_NODE, COMPUTER_NODE, BROADCAST_NODE,
+                ROUND_ROBIN_NODE, MERGE_NODE, INTERLEAVE_NODE };
+
+struct TopologyEdge {
+  size_t from;
+  size_t to;
+  // Not used when input node is read directly by a computer.
+  unique_ptr<RingBuffer> buffer;
+};
+
+struct TopologyNode {
+  NodeKind kind;
+  string name;
+  // Program of the computer, or file that input or output node uses
+  // instead of stdin or stdout.
+  string filename;
+  // Line of the declaration, used in error messages.
+  int line;
+  // Indices of edges.
+  vector<size_t> inEdges;
+  vector<size_t> outEdges;
+  unique_ptr<Computer> computer;
+  unique_ptr<PipeInput> input;
+  unique_ptr<StandardOutput> output;
+};
+
+/*
+ * Graph of computers, read from a topology file, that can have multiple
+ * named inputs and outputs, and can split and join the stream of words
+ * with fan-out and fan-in nodes. Every node runs on its own thread, or as
+ * a fiber on one of the worker threads, and edges between them are ring
+ * buffers, so independent branches run in parallel. See doc/topology.md
+ * for the file format.
+ */
+class Topology {
+  public:
+    Topology(string filename, bool outputNumbers, bool outputChars,
+             bool inputChars, bool rawInput, bool binary, Engine engine,
+             bool memoize, size_t fiberWorkersIn);
+    void run();
+
+  private:
+    string filename;
+    // Nodes run as fibers if not zero.
+    size_t fiberWorkers;
+    int lineNumber = 0;
+    vector<TopologyNode> nodes;
+    map<string, size_t> nodeIndices;
+    vector<TopologyEdge> edges;
+
+    void parseLine(const string &line);
+    void declareNode(const vector<string> &tokens);
+    void connectNodes(const string &line);
+    size_t getNodeIndex(const string &name);
+    void checkNodes();
+    void checkDegree(const TopologyNode &node, size_t minIn, size_t maxIn,
+                     size_t minOut, size_t maxOut);
+    void checkForCycles();
+    function<void()> getTask(TopologyNode &node);
+    void build(bool outputNumbers, bool outputChars, bool inputChars,
+               bool rawInput, bool binary, Engine engine, bool memoize);
+    string getPath(const string &name);
+    void fail(int line, const string &message);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "trace.hpp"
+
+#include <stdlib.h>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+
+#include "addr_space.hpp"
+#include "instruction.hpp"
+#include "isa.hpp"
+#include "util.hpp"
+
+using namespace std;
+
+static const char *TRACE_HEADER = "Comp Mark II trace 1\n";
+
+static string getCode(const TraceRecord &record);
+static string getReturn(const string &code);
+
+/*
+ * Once the trace is finishing, nobody empties the buffer anymore, so
+ * records that don't fit into it get dropped.
+ */
+void TraceBuffer::push(uint64_t cycle, uint8_t pc, uint8_t word, uint8_t reg,
+                       const Address &adr) {
+  size_t t = tail.load(memory_order_relaxed);
+  while (t - cachedHead == TRACE_BUFFER_RECORDS) {
+    if (finishing.load()) {
+      return;
+    }
+    this_thread::yield();
+    cachedHead = head.load(memory_order_acquire);
+  }
+  TraceRecord &record = records[t % TRACE_BUFFER_RECORDS];
+  record = TraceRecord();
+  record.cycle = cycle;
+  record.computer = computer;
+  record.pc = pc;
+  record.word = word;
+  record.reg = reg;
+  record.adr = adr.space << 4 | adr.val;
+  tail.store(t + 1, memory_order_release);
+}
+
+/*
+ * Records between the head and the end of the vector get written first,
+ * if the pushed ones wrap around.
+ */
+size_t TraceBuffer::flush(FILE *file) {
+  size_t h = head.load(memory_order_relaxed);
+  size_t t = tail.load(memory_order_acquire);
+  while (h != t) {
+    size_t index = h % TRACE_BUFFER_RECORDS;
+    size_t num = min(t - h, TRACE_BUFFER_RECORDS - index);
+    fwrite(&records[index], sizeof(TraceRecord), num, file);
+    h += num;
+  }
+  size_t num = h - head.load(memory_order_relaxed);
+  head.store(h, memory_order_release);
+  return num;
+}
+
+Trace::Trace(string filename, const vector<string> &names) {
+  file = fopen(filename.c_str(), "wb");
+  if (file == NULL) {
+    fprintf(stderr, "Could not open trace file '%s': %s. Aborting.\n",
+            filename.c_str(), strerror(errno));
+    exit(1);
+  }
+  fputs(TRACE_HEADER, file);
+  fprintf(file, "%zu\n", names.size());
+  for (size_t i = 0; i < names.size(); i++) {
+    fprintf(file, "%s\n", names[i].c_str());
+    buffers.push_back(unique_ptr<TraceBuffer>(new TraceBuffer(i, finishing)));
+  }
+  flusher = thread(&Trace::flushUntilFinished, this);
+}
+
+TraceBuffer *Trace::getBuffer(size_t computer) {
+  return buffers[computer].get();
+}
+
+/*
+ * Called at exit, possibly while other threads are still running their
+ * computers.
+ */
+void Trace::finish() {
+  if (finished) {
+    return;
+  }
+  finished = true;
+  finishing.store(true);
+  flusher.join();
+  for (auto &buffer : buffers) {
+    buffer->flush(file);
+  }
+  if (fclose(file) != 0) {
+    fprintf(stderr, "Could not write trace file: %s.\n", strerror(errno));
+  }
+}
+
+void Trace::print(string filename) {
+  FILE *in = fopen(filename.c_str(), "rb");
+  char line[TRACE_MAX_LINE];
+  size_t numOfComputers;
+  if (in == NULL || fgets(line, sizeof(line), in) == NULL ||
+      strcmp(line, TRACE_HEADER) != 0 ||
+      fscanf(in, "%zu", &numOfComputers) != 1 || fgetc(in) != '\n') {
+    fprintf(stderr, "Invalid trace file '%s'. Aborting.\n",
+            filename.c_str());
+    exit(1);
+  }
+  for (size_t i = 0; i < numOfComputers; i++) {
+    if (fgets(line, sizeof(line), in) == NULL) {
+      fprintf(stderr, "Invalid trace file '%s'. Aborting.\n",
+              filename.c_str());
+      exit(1);
+    }
+    printf("Computer %zu: %s", i, line);
+  }
+  printf("comp        cycle   pc  reg  instruction   code\n");
+  TraceRecord record;
+  while (fread(&record, sizeof(record), 1, in) == 1) {
+    Instruction inst = Instruction(record.word, record.reg, NULL);
+    printf("%4u %12llu %4u %4u  %-12s  %s\n", record.computer,
+           (unsigned long long) record.cycle, record.pc, record.reg,
+           inst.getText().c_str(), getCode(record).c_str());
+  }
+  fclose(in);
+}
+
+/// PRIVATE ///
+
+void Trace::flushUntilFinished() {
+  while (!finishing.load()) {
+    size_t num = 0;
+    for (auto &buffer : buffers) {
+      num += buffer->flush(file);
+    }
+    if (num == 0) {
+      this_thread::sleep_for(chrono::microseconds(TRACE_FLUSH_MICROSECONDS));
+    }
+  }
+}
+
+/*
+ * Code template of the instruction from the ISA table, with the recorded
+ * effective address in place of the operand. Reads of the IN/OUT address
+ * are shown as 'input()' and writes as 'output()'.
+ */
+static string getCode(const TraceRecord &record) {
+  Opcode opcode = Isa::decode(record.word);
+  const IsaEntry *entry = &Isa::get(opcode);
+  // Pointer got already resolved into the effective address.
+  if (opcode == READ_POINTER) {
+    entry = &Isa::get(READ);
+  } else if (opcode == WRITE_POINTER) {
+    entry = &Isa::get(WRITE);
+  }
+  Address adr = Address((AddrSpace) (record.adr >> 4), record.adr & 0x0f);
+  bool isIo = adr.space == DATA && adr.val == LAST_ADDRESS;
+  string code = (isIo && entry->ioCode != NULL) ? entry->ioCode
+                                                : entry->code;
+  code = Util::replaceAll(code, "pc = $PC; ", "");
+  code = Util::replaceAll(code, "reg&$SIZE", "$ADR");
+  code = Util::replaceAll(code, "goto *a[$ADR]", "goto $ADR");
+  code = Util::replaceAll(code, "$OP", isIo ? "input()" : "data[$ADR]");
+  code = Util::replaceAll(code, "$ADR2", to_string(entry->secondFixedAdr));
+  code = Util::replaceAll(code, "$ADR", to_string(adr.val));
+  code = Util::replaceAll(code, "$MAX", to_string(MAX_VALUE));
+  code = Util::replaceAll(code, "$SIZE", to_string(RAM_SIZE));
+  return getReturn(code);
+}
+
+/*
+ * Compiled program returns the words that it outputs.
+ */
+static string getReturn(const string &code) {
+  size_t returnIndex = code.find("return ");
+  if (returnIndex == string::npos) {
+    return code;
+  }
+  size_t wordIndex = returnIndex + 7;
+  size_t endIndex = code.find(';', wordIndex);
+  return code.substr(0, returnIndex) + "output(" +
+         code.substr(wordIndex, endIndex - wordIndex) + ")" +
+         code.substr(endIndex);
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "address.hpp"
+#include "const.hpp"
+
+using namespace std;
+
+/*
+ * One executed instruction, as it gets written to the trace file. Register
+ * holds the value from before the instruction was executed. Effective
+ * address is packed into one byte, with address space in the high nibble.
+ */
+struct TraceRecord {
+  uint64_t cycle;
+  uint16_t computer;
+  uint8_t pc;
+  uint8_t word;
+  uint8_t reg;
+  uint8_t adr;
+  uint8_t padding[2];
+};
+
+static_assert(sizeof(TraceRecord) == 16, "Trace record should be 16 bytes.");
+
+/*
+ * Records of one computer, waiting to be written to the file. Computer
+ * pushes and the background thread of the trace pops, so, same as with the
+ * ring buffer of the parallel chain, no locks are needed. Computer that
+ * fills the buffer waits for the thread to empty it, so no records get
+ * lost, unless the trace is already finishing.
+ */
+class TraceBuffer {
+  public:
+    TraceBuffer(uint16_t computerIn, const atomic<bool> &finishingIn)
+        : records(TRACE_BUFFER_RECORDS),
+          computer(computerIn),
+          finishing(finishingIn) { }
+    void push(uint64_t cycle, uint8_t pc, uint8_t word, uint8_t reg,
+              const Address &adr);
+    // Writes all pushed records to the file and returns their number.
+    size_t flush(FILE *file);
+
+  private:
+    vector<TraceRecord> records;
+    uint16_t computer;
+    // Set by the trace when it stops writing records.
+    const atomic<bool> &finishing;
+    // Used by the background thread.
+    atomic<size_t> head{0};
+    char consumerPadding[64];
+    // Used by computer.
+    atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    char producerPadding[64];
+};
+
+/*
+ * Binary trace of every instruction that the computers of a chain execute,
+ * written to a file while they run. File starts with a text header that
+ * holds the version and names of the computers, each on its own line,
+ * followed by the records in native byte order. Records of different
+ * computers are interleaved, but each computer's are in order.
+ */
+class Trace {
+  public:
+    Trace(string filename, const vector<string> &names);
+    TraceBuffer *getBuffer(size_t computer);
+    // Writes the remaining records and closes the file. Records pushed
+    // after that are ignored.
+    void finish();
+    // Prints the records of a trace file as text.
+    static void print(string filename);
+
+  private:
+    FILE *file;
+    vector<unique_ptr<TraceBuffer>> buffers;
+    thread flusher;
+    atomic<bool> finishing{false};
+    bool finished = false;
+
+    void flushUntilFinished();
+};
+
+#endif
\ No newline at end of file
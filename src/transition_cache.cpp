@@ -0,0 +1,28 @@
+#include "transition_cache.hpp"
+
+#include "const.hpp"
+
+using namespace std;
+
+/*
+ * Returns NULL if transition from the state is not cached.
+ */
+const Transition* TransitionCache::get(const MachineState &state) const {
+  auto it = transitions.find(state);
+  if (it == transitions.end()) {
+    return NULL;
+  }
+  return &it->second;
+}
+
+/*
+ * Returns pointer to the stored transition, that stays valid until the
+ * next call.
+ */
+const Transition* TransitionCache::put(const MachineState &state,
+                                       const Transition &transition) {
+  if (transitions.size() >= MAX_CACHED_TRANSITIONS) {
+    transitions.clear();
+  }
+  return &(transitions[state] = transition);
+}
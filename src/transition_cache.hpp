@@ -0,0 +1,39 @@
+#ifndef TRANSITION_CACHE_H
+#define TRANSITION_CACHE_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "engine.hpp"
+#include "machine_state.hpp"
+
+using namespace std;
+
+/*
+ * Where the program gets from some state, before it needs to read input.
+ * Result is RUN_INPUT if the next instruction reads input, RUN_STOPPED if
+ * the last address was reached, or RUN_BUDGET_SPENT if neither happened
+ * in MEMO_STEPS instructions.
+ */
+struct Transition {
+  MachineState next;
+  RunResult result;
+  vector<uint8_t> output;
+};
+
+/*
+ * Remembers transitions of a program, keyed by the starting state. Gets
+ * emptied when it reaches MAX_CACHED_TRANSITIONS entries.
+ */
+class TransitionCache {
+  public:
+    const Transition* get(const MachineState &state) const;
+    const Transition* put(const MachineState &state,
+                          const Transition &transition);
+
+  private:
+    unordered_map<MachineState, Transition, MachineStateHash> transitions;
+};
+
+#endif
@@ -1,7 +1,6 @@
 #include "util.hpp"
 
 #include <dirent.h>
-#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/select.h>
@@ -45,23 +44,16 @@ vector<bool> Util::getBoolNibb(int num) {
  * length is returned.
  */
 vector<bool> Util::getBool(int num, int length) {
+  int max = (1 << length) - 1;
   if (num <= 0) {
     return vector<bool>(length, false);
   }
-  if (num >= (int) pow(2, length)-1) {
+  if (num >= max) {
     return vector<bool>(length, true);
   }
   vector<bool> out(length);
-  int j = 0;
-  for (int i = length-1; i >= 0; i--) {
-    int divider = (int) pow(2, i);
-    int res = num / divider;
-    if (res > 0) {
-      out[j++] = true;
-    } else {
-      out[j++] = false;
-    }
-    num = num % divider;
+  for (int i = 0; i < length; i++) {
+    out[i] = (num >> (length-1-i)) & 1;
   }
   return out;
 }
@@ -122,26 +114,6 @@ string Util::getStringWithFormatedInt(vector<bool> wordIn) {
   return Util::getString(wordIn) + " " + Util::getFormatedInt(wordIn) + "\n";
 }
 
-vector<bool> Util::parseWord(string word) {
-  if (Util::startsWithDigit(word)) {
-    int num = Util::extractInteger(word);
-    return Util::getBoolByte(num);
-  } else {
-    return Util::getBoolByte(word);
-  }
-}
-
-vector<bool> Util::readWordFromPipe() {
-  string word;
-  // Read until next whitespace.
-  cin >> word;
-  // Exit when end of pipe input is reached.
-  if (!cin) {
-    exit(0);
-  }
-  return Util::parseWord(word);
-}
-
 /*
  * GENERAL UTIL
  */
@@ -393,6 +365,15 @@ bool Util::endsWith(string const &fullString, string const &ending) {
   }
 }
 
+string Util::replaceAll(string s, const string &from, const string &to) {
+  size_t pos = s.find(from);
+  while (pos != string::npos) {
+    s.replace(pos, from.length(), to);
+    pos = s.find(from, pos + to.length());
+  }
+  return s;
+}
+
 bool Util::isADir(string filename) {
   struct stat s;
   if (stat(filename.c_str(), &s) == 0) {
@@ -1,6 +1,7 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <stdint.h>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -22,8 +23,6 @@ class Util {
     static string getStringWithFormatedInt(vector<bool> wordIn);
     static vector<vector<bool>> getRamFromString(string ramString);
     static vector<bool> getRandomWord();
-    static vector<bool> parseWord(string word);
-    static vector<bool> readWordFromPipe();
     // UNICODE
     static vector<vector<string>> splitIntoLines(vector<string> drawing);
     // STRING
@@ -50,6 +49,7 @@ class Util {
     static size_t getSizeOfLargestElement(vector<vector<string>> lines);
     static vector<string> getFilesInDirectory(const string &directory);
     static bool endsWith(string const &fullString, string const &ending);
+    static string replaceAll(string s, const string &from, const string &to);
     static bool isADir(string filename);
     static bool contains(vector<string> options, const char* arg);
 };